@@ -7,12 +7,52 @@
 #define ROOT_HELPER_H
 
 
+/**
+ * With ROOT_HELPER_USE_COMPILED_LIBRARY defined beforehand (by the installed rootlogon.C when the environment variable of that name is set),
+ * the compiled library and its dictionary are loaded instead of JIT-compiling the sources.
+ */
+#ifdef ROOT_HELPER_USE_COMPILED_LIBRARY
+
+
+R__LOAD_LIBRARY(libROOThelperDict)
+
+#include "src/core/include/ROOT_helper/parallel.h"
+#include "src/core/include/ROOT_helper/trace.h"
+#include "src/core/include/ROOT_helper/object_registry.h"
+#include "src/core/include/ROOT_helper/data_saver.h"
+#include "src/core/include/ROOT_helper/file_pool.h"
+#include "src/core/include/ROOT_helper/graphics.h"
+#include "src/core/include/ROOT_helper/container.h"
+#include "src/core/include/ROOT_helper/analysis.h"
+#include "src/core/include/ROOT_helper/page_renderer.h"
+#include "src/core/include/ROOT_helper/time_series.h"
+#include "src/core/include/ROOT_helper/text_loader.h"
+#include "src/core/include/ROOT_helper/batch_fit.h"
+#include "src/core/include/ROOT_helper/stage_cache.h"
+#include "src/core/include/ROOT_helper/histo_merge.h"
+#include "src/core/include/ROOT_helper/transform.h"
+
+
+#else
+
+
 #define ROOT_HELPER_USED_IN_INTERPRETER
 
 
+#include "src/core/include/ROOT_helper/parallel.h"
+
+#include "src/core/include/ROOT_helper/trace.h"
+#include "src/core/trace.cpp"
+
+#include "src/core/include/ROOT_helper/object_registry.h"
+#include "src/core/object_registry.cpp"
+
 #include "src/core/include/ROOT_helper/data_saver.h"
 #include "src/core/data_saver.cpp"
 
+#include "src/core/include/ROOT_helper/file_pool.h"
+#include "src/core/file_pool.cpp"
+
 #include "src/core/include/ROOT_helper/graphics.h"
 #include "src/core/graphics.cpp"
 
@@ -22,5 +62,28 @@
 #include "src/core/include/ROOT_helper/analysis.h"
 #include "src/core/analysis.cpp"
 
+#include "src/core/include/ROOT_helper/page_renderer.h"
+#include "src/core/page_renderer.cpp"
+
+#include "src/core/include/ROOT_helper/time_series.h"
+#include "src/core/time_series.cpp"
+
+#include "src/core/include/ROOT_helper/text_loader.h"
+#include "src/core/text_loader.cpp"
+
+#include "src/core/include/ROOT_helper/batch_fit.h"
+#include "src/core/batch_fit.cpp"
+
+#include "src/core/include/ROOT_helper/stage_cache.h"
+#include "src/core/stage_cache.cpp"
+
+#include "src/core/include/ROOT_helper/histo_merge.h"
+#include "src/core/histo_merge.cpp"
+
+#include "src/core/include/ROOT_helper/transform.h"
+
+
+#endif
+
 
 #endif
@@ -1,7 +1,7 @@
 /**
  * Include this header for usage in ROOT cling interpreter.
  * Used only for an installed package.
- * In order to use in the interpreter, see auxiliary/rootlogon.C
+ * In order to use in the interpreter, see auxiliary/rootlogon.C.in
  */
 
 
@@ -9,12 +9,52 @@
 #define ROOT_HELPER_H
 
 
+/**
+ * With ROOT_HELPER_USE_COMPILED_LIBRARY defined beforehand (by the installed rootlogon.C when the environment variable of that name is set),
+ * the compiled library and its dictionary are loaded instead of JIT-compiling the sources.
+ */
+#ifdef ROOT_HELPER_USE_COMPILED_LIBRARY
+
+
+R__LOAD_LIBRARY(libROOThelperDict)
+
+#include "parallel.h"
+#include "trace.h"
+#include "object_registry.h"
+#include "data_saver.h"
+#include "file_pool.h"
+#include "graphics.h"
+#include "container.h"
+#include "analysis.h"
+#include "page_renderer.h"
+#include "time_series.h"
+#include "text_loader.h"
+#include "batch_fit.h"
+#include "stage_cache.h"
+#include "histo_merge.h"
+#include "transform.h"
+
+
+#else
+
+
 #define ROOT_HELPER_USED_IN_INTERPRETER
 
 
+#include "parallel.h"
+
+#include "trace.h"
+#include "src/trace.cpp"
+
+#include "object_registry.h"
+#include "src/object_registry.cpp"
+
 #include "data_saver.h"
 #include "src/data_saver.cpp"
 
+#include "file_pool.h"
+#include "src/file_pool.cpp"
+
 #include "graphics.h"
 #include "src/graphics.cpp"
 
@@ -24,5 +64,28 @@
 #include "analysis.h"
 #include "src/analysis.cpp"
 
+#include "page_renderer.h"
+#include "src/page_renderer.cpp"
+
+#include "time_series.h"
+#include "src/time_series.cpp"
+
+#include "text_loader.h"
+#include "src/text_loader.cpp"
+
+#include "batch_fit.h"
+#include "src/batch_fit.cpp"
+
+#include "stage_cache.h"
+#include "src/stage_cache.cpp"
+
+#include "histo_merge.h"
+#include "src/histo_merge.cpp"
+
+#include "transform.h"
+
+
+#endif
+
 
 #endif
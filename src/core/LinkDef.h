@@ -0,0 +1,64 @@
+/**
+ * Selection for the ROOThelperDict dictionary.
+ * Classes are registered without streamers since none of them is written to files.
+ * Free functions and templates are found through the precompiled module (.pcm) of the headers.
+ */
+#ifdef __CLING__
+
+#pragma link off all globals;
+#pragma link off all classes;
+#pragma link off all functions;
+
+#pragma link C++ nestedclasses;
+
+#pragma link C++ namespace ROOT_helper;
+#pragma link C++ namespace ROOT_helper::publish;
+#pragma link C++ namespace ROOT_helper::transform;
+
+#pragma link C++ class ROOT_helper::ObjectRegistry-;
+#pragma link C++ class ROOT_helper::ObjectRegistryScope-;
+#pragma link C++ class ROOT_helper::RegistryStats-;
+
+#pragma link C++ class ROOT_helper::DataSaver-;
+#pragma link C++ class ROOT_helper::DataIndex-;
+#pragma link C++ class ROOT_helper::DataIndexEntry-;
+
+#pragma link C++ class ROOT_helper::GraphicsSize-;
+#pragma link C++ class ROOT_helper::GraphicsContext-;
+#pragma link C++ class ROOT_helper::GraphicsContextBinding-;
+#pragma link C++ class ROOT_helper::CanvasPool-;
+#pragma link C++ class ROOT_helper::CanvasLayout-;
+#pragma link C++ class ROOT_helper::FrameRange-;
+#pragma link C++ class ROOT_helper::LayoutCacheStats-;
+#pragma link C++ enum ROOT_helper::LegendPosition;
+
+#pragma link C++ class ROOT_helper::FilePool-;
+#pragma link C++ class ROOT_helper::FilePoolStats-;
+
+#pragma link C++ class ROOT_helper::ObjectList-;
+#pragma link C++ class ROOT_helper::IContainerWrapper-;
+#pragma link C++ class ROOT_helper::MultiObject-;
+
+#pragma link C++ class ROOT_helper::SavitzkyGolayFilter-;
+#pragma link C++ class ROOT_helper::SpectrumAnalyzer-;
+#pragma link C++ class ROOT_helper::EnvelopeBuilder-;
+#pragma link C++ enum ROOT_helper::WindowFunction;
+#pragma link C++ enum ROOT_helper::EnvelopeBand;
+
+#pragma link C++ class ROOT_helper::PageLayout-;
+#pragma link C++ class ROOT_helper::PageInfo-;
+
+#pragma link C++ class ROOT_helper::StripChart-;
+#pragma link C++ class ROOT_helper::MinMaxPyramid-;
+#pragma link C++ class ROOT_helper::DownsampledGraph-;
+
+#pragma link C++ class ROOT_helper::TextTable-;
+#pragma link C++ class ROOT_helper::ColumnMapping-;
+
+#pragma link C++ class ROOT_helper::FitResultTable-;
+#pragma link C++ class ROOT_helper::BatchFitOption-;
+
+#pragma link C++ class ROOT_helper::StageCache-;
+#pragma link C++ class ROOT_helper::StageCacheStats-;
+
+#endif
@@ -1,10 +1,28 @@
 #ifndef ROOT_HELPER_USED_IN_INTERPRETER
 #include <ROOT_helper/analysis.h>
+#include <ROOT_helper/graphics.h>
 #endif
 
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <Math/BrentMinimizer1D.h>
+#include <Math/BrentRootFinder.h>
+#include <Math/Functor.h>
+#include <TArrayD.h>
 #include <TAxis.h>
 #include <TH1.h>
+#include <TH2.h>
+#include <TProfile.h>
+#include <TProfile2D.h>
+#include <TGraphAsymmErrors.h>
 #include <TGraphErrors.h>
+#include <TMath.h>
+#include <TSpline.h>
+#include <TString.h>
+#include <TVirtualFFT.h>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -15,58 +33,95 @@ namespace ROOT_helper
 {
 
 
-TH1* scale_histo_x(TH1* h, const double scale)
+GraphView make_graph_view(const TGraph* g)
 {
-    const int n_bin = h->GetXaxis()->GetNbins();
-    const double x_min = h->GetXaxis()->GetBinLowEdge(1);
-    const double x_max = h->GetXaxis()->GetBinUpEdge(n_bin);
+    const size_t n = g->GetN();
 
-    h->SetBins(n_bin, x_min * scale, x_max * scale);
+    auto view_of = [n](const double* array) { return array ? Span<const double>(array, n) : Span<const double>(); };
 
-    return h;
+    return { view_of(g->GetX()), view_of(g->GetY()), view_of(g->GetEX()), view_of(g->GetEY()) };
 }
 
 
-TH1* convert_to_density_histo(TH1* h)
+MutableGraphView make_mutable_graph_view(TGraph* g)
 {
-    const int n_bin = h->GetXaxis()->GetNbins();
+    const size_t n = g->GetN();
+
+    auto view_of = [n](double* array) { return array ? Span<double>(array, n) : Span<double>(); };
+
+    return { view_of(g->GetX()), view_of(g->GetY()), view_of(g->GetEX()), view_of(g->GetEY()) };
+}
 
-    const double integral = h->Integral();
 
-    for (int i_bin = 1; i_bin <= n_bin; ++i_bin) {
-	const double bin_width = h->GetXaxis()->GetBinWidth(i_bin);
-	h->SetBinContent(i_bin, h->GetBinContent(i_bin) / bin_width / integral);
-	h->SetBinError(i_bin, h->GetBinError(i_bin) / bin_width / integral);
+void scale_bin_edges(Span<double> edges, const double scale)
+{
+    for (auto& edge : edges) {
+	edge *= scale;
     }
+}
 
-    return h;
+
+template<class BinWidthType>
+void convert_to_density_with(BinWidthType bin_width, Span<double> content, Span<double> sumw2)
+{
+    const size_t n_bin = content.size();
+
+    double integral = 0;
+    for (size_t i_bin = 0; i_bin < n_bin; ++i_bin) {
+	integral += content[i_bin];
+    }
+
+    for (size_t i_bin = 0; i_bin < n_bin; ++i_bin) {
+	const double factor = 1. / bin_width(i_bin) / integral;
+	content[i_bin] *= factor;
+	if (!sumw2.empty()) sumw2[i_bin] *= factor * factor;
+    }
 }
 
 
-TGraphErrors* get_graph_g0xa_plus_g1(const double a, const TGraphErrors* g0, const TGraphErrors* g1)
+void convert_to_density(Span<const double> edges, Span<double> content, Span<double> sumw2)
 {
-    const int n_data = g0->GetN();
+    if (edges.size() != content.size() + 1) {
+	fprintf(stderr, "number of bin edges does not match the number of bins for the density conversion\n");
+	exit(1);
+    }
 
-    if (n_data != g1->GetN()) {
+    convert_to_density_with([edges](const size_t i_bin) { return edges[i_bin + 1] - edges[i_bin]; }, content, sumw2);
+}
+
+
+void convert_to_density(const double bin_width, Span<double> content, Span<double> sumw2)
+{
+    convert_to_density_with([bin_width](const size_t) { return bin_width; }, content, sumw2);
+}
+
+
+void get_g0xa_plus_g1(const double a, const GraphView& g0, const GraphView& g1, const MutableGraphView& g_sum)
+{
+    const size_t n_data = g0.size();
+
+    if (n_data != g1.size()) {
 	fprintf(stderr, "graphs with different number of points were selected for the diff. calculation\n");
 	exit(1);
     }
 
-    TGraphErrors* g_sum = new TGraphErrors(n_data);
+    if (g_sum.size() != n_data || g_sum.ex.size() != n_data || g_sum.ey.size() != n_data) {
+	fprintf(stderr, "output arrays of the diff. calculation do not match the number of points\n");
+	exit(1);
+    }
 
-    g_sum->GetXaxis()->SetTitle(g0->GetXaxis()->GetTitle());
-    g_sum->GetYaxis()->SetTitle(g0->GetYaxis()->GetTitle());
+    auto error_at = [](const Span<const double>& e, const size_t i) { return e.empty() ? 0. : e[i]; };
 
-    for (int i_data = 0; i_data < n_data; ++i_data) {
-	const double x_0 = g0->GetX()[i_data];
-	const double ex_0 = g0->GetEX()[i_data];
-	const double y_0 = g0->GetY()[i_data];
-	const double ey_0 = g0->GetEY()[i_data];
+    for (size_t i_data = 0; i_data < n_data; ++i_data) {
+	const double x_0 = g0.x[i_data];
+	const double ex_0 = error_at(g0.ex, i_data);
+	const double y_0 = g0.y[i_data];
+	const double ey_0 = error_at(g0.ey, i_data);
 
-	const double x_1 = g1->GetX()[i_data];
-	const double ex_1 = g1->GetEX()[i_data];
-	const double y_1 = g1->GetY()[i_data];
-	const double ey_1 = g1->GetEY()[i_data];
+	const double x_1 = g1.x[i_data];
+	const double ex_1 = error_at(g1.ex, i_data);
+	const double y_1 = g1.y[i_data];
+	const double ey_1 = error_at(g1.ey, i_data);
 
 
 	double x, ex, y, ey;
@@ -87,11 +142,998 @@ TGraphErrors* get_graph_g0xa_plus_g1(const double a, const TGraphErrors* g0, con
 	y = a * y_0 + y_1;
 	ey = std::sqrt(std::pow(a * ey_0, 2) + std::pow(ey_1, 2));
 
-	g_sum->SetPoint(i_data, x, y);
-	g_sum->SetPointError(i_data, ex, ey);
+	g_sum.x[i_data] = x;
+	g_sum.ex[i_data] = ex;
+	g_sum.y[i_data] = y;
+	g_sum.ey[i_data] = ey;
+    }
+}
+
+
+/**
+ * Same Brent scan (100 points, 1e-10 tolerance) as TF1::GetX/GetMaximumX on a cubic spline, without a TF1.
+ */
+double find_x(Span<const double> x, Span<const double> y, const double y_target, double x_start, double x_end)
+{
+    if (x_start >= x_end) {
+	x_start = *std::min_element(x.begin(), x.end());
+	x_end = *std::max_element(x.begin(), x.end());
+    }
+
+    TSpline3 spl("spl_g", x.data(), y.data(), x.size());
+
+    const int n_scan = 100;
+    const int max_iteration = 100;
+    const double epsilon = 1e-10;
+
+    ROOT::Math::Functor1D f_max([&spl](const double x) { return -spl.Eval(x); });
+    ROOT::Math::BrentMinimizer1D max_finder;
+    max_finder.SetFunction(f_max, x_start, x_end);
+    max_finder.SetNpx(n_scan);
+    max_finder.Minimize(max_iteration, epsilon, epsilon);
+
+    if (y_target > -max_finder.FValMinimum()) {
+	return max_finder.XMinimum();
+    }
+
+    ROOT::Math::Functor1D f_min([&spl](const double x) { return spl.Eval(x); });
+    ROOT::Math::BrentMinimizer1D min_finder;
+    min_finder.SetFunction(f_min, x_start, x_end);
+    min_finder.SetNpx(n_scan);
+    min_finder.Minimize(max_iteration, epsilon, epsilon);
+
+    if (y_target < min_finder.FValMinimum()) {
+	return min_finder.XMinimum();
+    }
+
+    ROOT::Math::Functor1D f_root([&spl, y_target](const double x) { return spl.Eval(x) - y_target; });
+    ROOT::Math::BrentRootFinder root_finder;
+    root_finder.SetFunction(f_root, x_start, x_end);
+    root_finder.SetNpx(n_scan);
+    root_finder.Solve(max_iteration, epsilon, epsilon);
+
+    return root_finder.Root();
+}
+
+
+void moving_average(Span<const double> in, Span<double> out, const size_t half_window, const bool is_variance)
+{
+    const size_t n = in.size();
+
+    std::vector<double> prefix_sum(n + 1);
+    prefix_sum[0] = 0;
+    for (size_t i = 0; i < n; ++i) {
+	prefix_sum[i + 1] = prefix_sum[i] + in[i];
+    }
+
+    auto average = [&](const size_t low, const size_t high)
+    {
+	const double width = high - low;
+	return (prefix_sum[high] - prefix_sum[low]) / (is_variance ? width * width : width);
+    };
+
+    const size_t n_window = 2 * half_window + 1;
+    const double norm = is_variance ? 1. / (n_window * n_window) : 1. / n_window;
+
+    for (size_t i = half_window; i + half_window < n; ++i) {
+	out[i] = (prefix_sum[i + half_window + 1] - prefix_sum[i - half_window]) * norm;
+    }
+
+    for (size_t i = 0; i < std::min(half_window, n); ++i) {
+	out[i] = average(0, std::min(n, i + half_window + 1));
+	const size_t i_right = n - 1 - i;
+	out[i_right] = average(i_right >= half_window ? i_right - half_window : 0, n);
+    }
+}
+
+
+SavitzkyGolayFilter::SavitzkyGolayFilter(const size_t half_window, const int polynomial_order)
+: half_window_(half_window), polynomial_order_(polynomial_order)
+{
+    const int n_window = 2 * half_window_ + 1;
+    const int n_param = polynomial_order_ + 1;
+
+    if (polynomial_order_ < 0 || n_param > n_window) {
+	fprintf(stderr, "polynomial order %d of Savitzky-Golay filter does not fit in window of %d points\n", polynomial_order_, n_window);
+	exit(1);
+    }
+
+    auto position = [this](const int i) { return half_window_ == 0 ? 0. : (i - static_cast<double>(half_window_)) / half_window_; };
+
+    std::vector<double> normal(n_param * n_param, 0);
+    std::vector<double> inverse(n_param * n_param, 0);
+
+    for (int i = 0; i < n_window; ++i) {
+	for (int p = 0; p < n_param; ++p) {
+	    for (int q = 0; q < n_param; ++q) {
+		normal[p * n_param + q] += std::pow(position(i), p + q);
+	    }
+	}
+    }
+
+    for (int p = 0; p < n_param; ++p) {
+	inverse[p * n_param + p] = 1;
+    }
+
+    for (int col = 0; col < n_param; ++col) {
+	int pivot = col;
+	for (int row = col + 1; row < n_param; ++row) {
+	    if (std::abs(normal[row * n_param + col]) > std::abs(normal[pivot * n_param + col])) pivot = row;
+	}
+	for (int k = 0; k < n_param; ++k) {
+	    std::swap(normal[col * n_param + k], normal[pivot * n_param + k]);
+	    std::swap(inverse[col * n_param + k], inverse[pivot * n_param + k]);
+	}
+
+	const double diagonal = normal[col * n_param + col];
+	for (int k = 0; k < n_param; ++k) {
+	    normal[col * n_param + k] /= diagonal;
+	    inverse[col * n_param + k] /= diagonal;
+	}
+
+	for (int row = 0; row < n_param; ++row) {
+	    if (row == col) continue;
+	    const double factor = normal[row * n_param + col];
+	    for (int k = 0; k < n_param; ++k) {
+		normal[row * n_param + k] -= factor * normal[col * n_param + k];
+		inverse[row * n_param + k] -= factor * inverse[col * n_param + k];
+	    }
+	}
+    }
+
+    coefficient_.resize(n_window * n_window);
+    squared_coefficient_.resize(n_window * n_window);
+
+    std::vector<double> z(n_param);
+
+    for (int i_row = 0; i_row < n_window; ++i_row) {
+	const double t = position(i_row);
+
+	for (int p = 0; p < n_param; ++p) {
+	    z[p] = 0;
+	    for (int q = 0; q < n_param; ++q) {
+		z[p] += inverse[p * n_param + q] * std::pow(t, q);
+	    }
+	}
+
+	for (int j = 0; j < n_window; ++j) {
+	    double c = 0;
+	    for (int p = 0; p < n_param; ++p) {
+		c += z[p] * std::pow(position(j), p);
+	    }
+	    coefficient_[i_row * n_window + j] = c;
+	    squared_coefficient_[i_row * n_window + j] = c * c;
+	}
+    }
+}
+
+
+/**
+ * Arrays shorter than the window are processed with the largest window that fits.
+ */
+void SavitzkyGolayFilter::apply(Span<const double> in, Span<double> out, const bool is_variance) const
+{
+    const size_t n = in.size();
+    const size_t n_window = 2 * half_window_ + 1;
+
+    if (n == 0) return;
+
+    if (n < n_window) {
+	const size_t half_window = (n - 1) / 2;
+	SavitzkyGolayFilter(half_window, std::min<int>(polynomial_order_, 2 * half_window)).apply(in, out, is_variance);
+	return;
+    }
+
+    const std::vector<double>& coefficient = is_variance ? squared_coefficient_ : coefficient_;
+
+    auto convolve = [n_window](const double* c, const double* x)
+    {
+	double sum = 0;
+	for (size_t j = 0; j < n_window; ++j) {
+	    sum += c[j] * x[j];
+	}
+	return sum;
+    };
+
+    const double* c_center = coefficient.data() + half_window_ * n_window;
+    for (size_t i = half_window_; i + half_window_ < n; ++i) {
+	out[i] = convolve(c_center, in.data() + i - half_window_);
+    }
+
+    for (size_t i = 0; i < half_window_; ++i) {
+	out[i] = convolve(coefficient.data() + i * n_window, in.data());
+	out[n - half_window_ + i] = convolve(coefficient.data() + (half_window_ + 1 + i) * n_window, in.data() + n - n_window);
+    }
+}
+
+
+/**
+ * The backward pass sees correlated outputs of the forward pass, so squared weights do not propagate variances through it.
+ * With b = 1 - alpha and q = b^2, input k >= 1 reaches output i with weight c1 b^|i-k| + c2 b^(2(n-1)-i-k),
+ * c1 = alpha / (1 + b), c2 = alpha b / (1 + b); input 0 reaches it with (b^i + b^(2n-1-i)) / (1 + b).
+ * The squared weights are summed with running sums, so this stays O(n).
+ */
+static void propagate_zero_phase_exponential_variance(Span<const double> v, Span<double> out, const double alpha)
+{
+    const size_t n = v.size();
+    const double b = 1 - alpha;
+    const double q = b * b;
+    const double c1 = alpha / (1 + b);
+    const double c2 = alpha * b / (1 + b);
+
+    // left[i] = sum_{1 <= k <= i} v_k q^(i-k), right[i] = sum_{k >= max(i, 1)} v_k q^(k-i)
+    // head[i] = sum_{1 <= k <= i} v_k q^(n-1-k), tail[i] = sum_{k > max(i, 0)} v_k
+    std::vector<double> left(n, 0), right(n + 1, 0), head(n, 0), tail(n + 1, 0);
+
+    for (size_t i = 1; i < n; ++i) {
+	left[i] = v[i] + q * left[i - 1];
+	head[i] = head[i - 1] + v[i] * std::pow(q, n - 1 - i);
+    }
+    for (size_t i = n - 1; i >= 1; --i) {
+	right[i] = v[i] + q * right[i + 1];
+	tail[i - 1] = tail[i] + v[i];
+    }
+    right[0] = q * right[1];
+
+    const double v0 = v[0];
+
+    for (size_t i = 0; i < n; ++i) {
+	const double q_to_end = std::pow(q, n - 1 - i);
+	const double same_side = i == 0 ? right[0] : left[i] + right[i] - v[i];
+	const double cross = head[i] + q_to_end * tail[i];
+	const double w0 = (std::pow(b, i) + std::pow(b, 2 * n - 1 - i)) / (1 + b);
+
+	out[i] = c1 * c1 * same_side + 2 * c1 * c2 * cross + c2 * c2 * q_to_end * head[n - 1] + w0 * w0 * v0;
+    }
+}
+
+
+void exponential_smoothing(Span<const double> in, Span<double> out, const double alpha, const bool zero_phase, const bool is_variance)
+{
+    const size_t n = in.size();
+
+    if (n == 0) return;
+
+    if (zero_phase && is_variance) {
+	propagate_zero_phase_exponential_variance(in, out, alpha);
+	return;
+    }
+
+    const double w_new = is_variance ? alpha * alpha : alpha;
+    const double w_old = is_variance ? (1 - alpha) * (1 - alpha) : 1 - alpha;
+
+    out[0] = in[0];
+    for (size_t i = 1; i < n; ++i) {
+	out[i] = w_new * in[i] + w_old * out[i - 1];
+    }
+
+    if (zero_phase) {
+	for (size_t i = n - 1; i-- > 0;) {
+	    out[i] = w_new * out[i] + w_old * out[i + 1];
+	}
+    }
+}
+
+
+TH1* scale_histo_x(TH1* h, const double scale)
+{
+    TAxis* axis = h->GetXaxis();
+    const int n_bin = axis->GetNbins();
+
+    if (axis->IsVariableBinSize()) {
+	const double* orig_edges = axis->GetXbins()->GetArray();
+	std::vector<double> edges(orig_edges, orig_edges + n_bin + 1);
+
+	scale_bin_edges(edges, scale);
+	h->SetBins(n_bin, edges.data());
+
+	return h;
+    }
+
+    const double x_min = axis->GetBinLowEdge(1);
+    const double x_max = axis->GetBinUpEdge(n_bin);
+
+    h->SetBins(n_bin, x_min * scale, x_max * scale);
+
+    return h;
+}
+
+
+/**
+ * One-dimensional double-precision histograms are converted in place on their bin arrays.
+ * Others go through copies of the bin contents.
+ * The number of entries is kept and the statistics are recomputed from the bins.
+ */
+TH1* convert_to_density_histo(TH1* h)
+{
+    TAxis* axis = h->GetXaxis();
+    const int n_bin = axis->GetNbins();
+
+    h->BufferEmpty();
+    if (h->GetSumw2N() == 0) h->Sumw2();
+
+    auto convert = [axis, n_bin](Span<double> content, Span<double> sumw2)
+    {
+	if (axis->IsVariableBinSize()) {
+	    convert_to_density(Span<const double>(axis->GetXbins()->GetArray(), n_bin + 1), content, sumw2);
+	} else {
+	    convert_to_density(axis->GetBinWidth(1), content, sumw2);
+	}
+    };
+
+    auto* array = dynamic_cast<TArrayD*>(h);
+
+    if (array && h->GetDimension() == 1) {
+	convert(Span<double>(array->GetArray() + 1, n_bin), Span<double>(h->GetSumw2()->GetArray() + 1, n_bin));
+    } else {
+	std::vector<double> content(n_bin);
+	std::vector<double> sumw2(n_bin);
+	for (int i_bin = 1; i_bin <= n_bin; ++i_bin) {
+	    content[i_bin - 1] = h->GetBinContent(i_bin);
+	    sumw2[i_bin - 1] = std::pow(h->GetBinError(i_bin), 2);
+	}
+
+	convert(content, sumw2);
+
+	for (int i_bin = 1; i_bin <= n_bin; ++i_bin) {
+	    h->SetBinContent(i_bin, content[i_bin - 1]);
+	    h->SetBinError(i_bin, std::sqrt(sumw2[i_bin - 1]));
+	}
+    }
+
+    const double n_entries = h->GetEntries();
+    h->ResetStats();
+    h->SetEntries(n_entries);
+
+    return h;
+}
+
+
+/**
+ * Bin lookup matching TAxis::FindBin, including NaN going to the overflow bin.
+ */
+class AxisBinner
+{
+public:
+    AxisBinner(const TAxis* axis)
+    : n_bin_(axis->GetNbins()), x_min_(axis->GetXmin()), x_max_(axis->GetXmax()),
+      edges_(axis->GetXbins()->GetSize() > 0 ? axis->GetXbins()->GetArray() : nullptr)
+    {
+    }
+
+    /**
+     * Block form so that the uniform case vectorizes.
+     */
+    void find_bins(const double* __restrict x, const size_t n, int* __restrict bin) const
+    {
+	if (edges_) {
+	    for (size_t i = 0; i < n; ++i) {
+		if (x[i] < x_min_) bin[i] = 0;
+		else if (!(x[i] < x_max_)) bin[i] = n_bin_ + 1;
+		else bin[i] = std::upper_bound(edges_, edges_ + n_bin_ + 1, x[i]) - edges_;
+	    }
+	} else {
+	    const int n_bin = n_bin_;
+	    const double x_min = x_min_;
+	    const double x_max = x_max_;
+	    const double width = x_max_ - x_min_;
+	    for (size_t i = 0; i < n; ++i) {
+		// Clamped before the conversion, which is undefined for NaN, infinities and values far out of range.
+		const double t = std::max(0., std::min(n_bin - 1., n_bin * (x[i] - x_min) / width));
+		const int in_range = 1 + static_cast<int>(t);
+		bin[i] = x[i] < x_min ? 0 : (x[i] < x_max ? in_range : n_bin + 1);
+	    }
+	}
+    }
+
+    bool is_in_range(const int bin) const { return bin > 0 && bin <= n_bin_; }
+
+private:
+    int n_bin_;
+    double x_min_;
+    double x_max_;
+    const double* edges_;
+};
+
+
+/**
+ * Per-thread partial sums; stats follows the layout of TH1::GetStats.
+ */
+struct PartialFill
+{
+    std::vector<double> sumw;
+    std::vector<double> sumw2;
+    double stats[7] = { 0, 0, 0, 0, 0, 0, 0 };
+};
+
+
+static bool is_bulk_fillable(TH1* h)
+{
+    return !h->GetBuffer() && !h->CanExtendAllAxes() && !h->GetStatOverflowsBehaviour()
+	&& !h->GetXaxis()->GetLabels() && !h->GetYaxis()->GetLabels();
+}
+
+
+static void add_partial_fills(TH1* h, std::vector<PartialFill>& partial_list, const size_t n_entry, const int n_stats)
+{
+    const size_t n_cell = h->GetNcells();
+    const bool has_sumw2 = h->GetSumw2N() > 0;
+    double* sumw2 = has_sumw2 ? h->GetSumw2()->GetArray() : nullptr;
+
+    double stats[7] = { 0, 0, 0, 0, 0, 0, 0 };
+    h->GetStats(stats);
+
+    for (const auto& partial : partial_list) {
+	for (size_t bin = 0; bin < n_cell; ++bin) {
+	    if (partial.sumw[bin] != 0) h->AddBinContent(bin, partial.sumw[bin]);
+	    if (sumw2) sumw2[bin] += partial.sumw2[bin];
+	}
+	for (int i = 0; i < n_stats; ++i) stats[i] += partial.stats[i];
+    }
+
+    const double n_entry_before = h->GetEntries();
+    h->PutStats(stats);
+    h->SetEntries(n_entry_before + n_entry);
+}
+
+
+TH1* bulk_fill_histo(TH1* h, Span<const double> x, Span<const double> w, unsigned int n_thread)
+{
+    const size_t n = x.size();
+
+    if (h->GetDimension() != 1 || h->InheritsFrom(TProfile::Class())) {
+	fprintf(stderr, "bulk fill of %s: %s is not a one-dimensional histogram\n", h->GetName(), h->ClassName());
+	exit(1);
+    }
+
+    if (!w.empty() && w.size() != n) {
+	fprintf(stderr, "bulk fill of %s: %zu weights for %zu entries\n", h->GetName(), w.size(), n);
+	exit(1);
+    }
+
+    if (!is_bulk_fillable(h)) {
+	for (size_t i = 0; i < n; ++i) h->Fill(x[i], w.empty() ? 1. : w[i]);
+	return h;
+    }
+
+    if (!w.empty() && h->GetSumw2N() == 0) h->Sumw2();
+
+    const size_t n_cell = h->GetNcells();
+    const AxisBinner binner(h->GetXaxis());
+
+    if (n_thread == 0) n_thread = get_default_n_thread();
+    n_thread = std::max<size_t>(1, std::min<size_t>(n_thread, n / 65536));
+
+    std::vector<PartialFill> partial_list(n_thread);
+
+    parallel_for(n_thread, [&](const size_t i_thread)
+    {
+	PartialFill& partial = partial_list[i_thread];
+	partial.sumw.assign(n_cell, 0);
+	partial.sumw2.assign(n_cell, 0);
+
+	constexpr size_t n_block = 256;
+	int bin[n_block];
+
+	const size_t i_begin = n * i_thread / n_thread;
+	const size_t i_end = n * (i_thread + 1) / n_thread;
+
+	for (size_t i_block = i_begin; i_block < i_end; i_block += n_block) {
+	    const size_t n_in_block = std::min(n_block, i_end - i_block);
+
+	    binner.find_bins(x.data() + i_block, n_in_block, bin);
+
+	    for (size_t j = 0; j < n_in_block; ++j) {
+		const double v = x[i_block + j];
+		const double weight = w.empty() ? 1. : w[i_block + j];
+
+		partial.sumw[bin[j]] += weight;
+		partial.sumw2[bin[j]] += weight * weight;
+
+		if (binner.is_in_range(bin[j])) {
+		    partial.stats[0] += weight;
+		    partial.stats[1] += weight * weight;
+		    partial.stats[2] += weight * v;
+		    partial.stats[3] += weight * v * v;
+		}
+	    }
+	}
+    }, n_thread);
+
+    add_partial_fills(h, partial_list, n, 4);
+
+    return h;
+}
+
+
+TH2* bulk_fill_histo(TH2* h, Span<const double> x, Span<const double> y, Span<const double> w, unsigned int n_thread)
+{
+    const size_t n = x.size();
+
+    if (h->GetDimension() != 2 || h->InheritsFrom(TProfile2D::Class())) {
+	fprintf(stderr, "bulk fill of %s: %s is not a two-dimensional histogram\n", h->GetName(), h->ClassName());
+	exit(1);
+    }
+
+    if (y.size() != n || (!w.empty() && w.size() != n)) {
+	fprintf(stderr, "bulk fill of %s: columns of different lengths\n", h->GetName());
+	exit(1);
+    }
+
+    if (!is_bulk_fillable(h)) {
+	for (size_t i = 0; i < n; ++i) h->Fill(x[i], y[i], w.empty() ? 1. : w[i]);
+	return h;
+    }
+
+    if (!w.empty() && h->GetSumw2N() == 0) h->Sumw2();
+
+    const size_t n_cell = h->GetNcells();
+    const int n_cell_x = h->GetNbinsX() + 2;
+    const AxisBinner x_binner(h->GetXaxis());
+    const AxisBinner y_binner(h->GetYaxis());
+
+    if (n_thread == 0) n_thread = get_default_n_thread();
+    n_thread = std::max<size_t>(1, std::min<size_t>(n_thread, n / 65536));
+
+    std::vector<PartialFill> partial_list(n_thread);
+
+    parallel_for(n_thread, [&](const size_t i_thread)
+    {
+	PartialFill& partial = partial_list[i_thread];
+	partial.sumw.assign(n_cell, 0);
+	partial.sumw2.assign(n_cell, 0);
+
+	constexpr size_t n_block = 256;
+	int x_bin[n_block];
+	int y_bin[n_block];
+
+	const size_t i_begin = n * i_thread / n_thread;
+	const size_t i_end = n * (i_thread + 1) / n_thread;
+
+	for (size_t i_block = i_begin; i_block < i_end; i_block += n_block) {
+	    const size_t n_in_block = std::min(n_block, i_end - i_block);
+
+	    x_binner.find_bins(x.data() + i_block, n_in_block, x_bin);
+	    y_binner.find_bins(y.data() + i_block, n_in_block, y_bin);
+
+	    for (size_t j = 0; j < n_in_block; ++j) {
+		const double vx = x[i_block + j];
+		const double vy = y[i_block + j];
+		const double weight = w.empty() ? 1. : w[i_block + j];
+		const int bin = x_bin[j] + n_cell_x * y_bin[j];
+
+		partial.sumw[bin] += weight;
+		partial.sumw2[bin] += weight * weight;
+
+		if (x_binner.is_in_range(x_bin[j]) && y_binner.is_in_range(y_bin[j])) {
+		    partial.stats[0] += weight;
+		    partial.stats[1] += weight * weight;
+		    partial.stats[2] += weight * vx;
+		    partial.stats[3] += weight * vx * vx;
+		    partial.stats[4] += weight * vy;
+		    partial.stats[5] += weight * vy * vy;
+		    partial.stats[6] += weight * vx * vy;
+		}
+	    }
+	}
+    }, n_thread);
+
+    add_partial_fills(h, partial_list, n, 7);
+
+    return h;
+}
+
+
+TGraphErrors* get_graph_g0xa_plus_g1(const double a, const TGraphErrors* g0, const TGraphErrors* g1)
+{
+    const int n_data = g0->GetN();
+
+    if (n_data != g1->GetN()) {
+	fprintf(stderr, "graphs with different number of points were selected for the diff. calculation\n");
+	exit(1);
+    }
+
+    TGraphErrors* g_sum = new TGraphErrors(n_data);
+
+    g_sum->GetXaxis()->SetTitle(g0->GetXaxis()->GetTitle());
+    g_sum->GetYaxis()->SetTitle(g0->GetYaxis()->GetTitle());
+
+    get_g0xa_plus_g1(a, make_graph_view(g0), make_graph_view(g1), make_mutable_graph_view(g_sum));
+
+    return register_in_current_scope(g_sum);
+}
+
+
+double find_x(const TGraph* g, const double y, double x_start, double x_end)
+{
+    const GraphView view = make_graph_view(g);
+    return find_x(view.x, view.y, y, x_start, x_end);
+}
+
+
+template<class KernelType>
+TGraph* smooth_graph_with(TGraph* g, KernelType kernel)
+{
+    const MutableGraphView view = make_mutable_graph_view(g);
+    const size_t n = view.size();
+
+    std::vector<double> buffer(view.y.begin(), view.y.end());
+    kernel(Span<const double>(buffer), view.y, false);
+
+    if (!view.ey.empty()) {
+	std::vector<double> variance(n);
+	for (size_t i = 0; i < n; ++i) {
+	    buffer[i] = view.ey[i] * view.ey[i];
+	}
+
+	kernel(Span<const double>(buffer), Span<double>(variance), true);
+
+	for (size_t i = 0; i < n; ++i) {
+	    view.ey[i] = std::sqrt(variance[i]);
+	}
+    }
+
+    g->SetBit(TGraph::kResetHisto);
+
+    return g;
+}
+
+
+TGraph* smooth_graph_moving_average(TGraph* g, const size_t half_window)
+{
+    return smooth_graph_with(g, [half_window](Span<const double> in, Span<double> out, const bool is_variance)
+    {
+	moving_average(in, out, half_window, is_variance);
+    });
+}
+
+
+TGraph* smooth_graph_savitzky_golay(TGraph* g, const SavitzkyGolayFilter& filter)
+{
+    return smooth_graph_with(g, [&filter](Span<const double> in, Span<double> out, const bool is_variance)
+    {
+	filter.apply(in, out, is_variance);
+    });
+}
+
+
+TGraph* smooth_graph_savitzky_golay(TGraph* g, const size_t half_window, const int polynomial_order)
+{
+    return smooth_graph_savitzky_golay(g, SavitzkyGolayFilter(half_window, polynomial_order));
+}
+
+
+TGraph* smooth_graph_exponential(TGraph* g, const double alpha, const bool zero_phase)
+{
+    return smooth_graph_with(g, [alpha, zero_phase](Span<const double> in, Span<double> out, const bool is_variance)
+    {
+	exponential_smoothing(in, out, alpha, zero_phase, is_variance);
+    });
+}
+
+
+std::vector<double> get_window_coefficients(const WindowFunction window, const size_t n)
+{
+    std::vector<double> coefficient(n, 1.);
+
+    if (n < 2) return coefficient;
+
+    const double step = TMath::TwoPi() / (n - 1);
+
+    for (size_t i = 0; i < n; ++i) {
+	const double phase = step * i;
+
+	switch (window) {
+	    case WindowFunction::Rectangular:
+		break;
+	    case WindowFunction::Hann:
+		coefficient[i] = 0.5 - 0.5 * std::cos(phase);
+		break;
+	    case WindowFunction::Hamming:
+		coefficient[i] = 0.54 - 0.46 * std::cos(phase);
+		break;
+	    case WindowFunction::Blackman:
+		coefficient[i] = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2 * phase);
+		break;
+	}
+    }
+
+    return coefficient;
+}
+
+
+/**
+ * FFTW plan creation and destruction are not thread-safe.
+ */
+static std::mutex& get_fft_plan_mutex()
+{
+    static std::mutex fft_plan_mutex;
+    return fft_plan_mutex;
+}
+
+
+SpectrumAnalyzer::SpectrumAnalyzer(const WindowFunction window)
+: window_(window)
+{
+}
+
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    std::lock_guard<std::mutex> lock(get_fft_plan_mutex());
+    plan_list_.clear();
+}
+
+
+SpectrumAnalyzer::Plan& SpectrumAnalyzer::transform(const TGraph* g, double& frequency_step)
+{
+    int n = g->GetN();
+
+    if (n < 2) {
+	fprintf(stderr, "spectrum of %s requires at least two points\n", g->GetName());
+	exit(1);
+    }
+
+    auto it_plan = plan_list_.find(n);
+
+    if (it_plan == plan_list_.end()) {
+	Plan plan;
+
+	{
+	    std::lock_guard<std::mutex> lock(get_fft_plan_mutex());
+	    plan.fft.reset(TVirtualFFT::FFT(1, &n, "R2C M K"));
+	}
+
+	if (!plan.fft) {
+	    fprintf(stderr, "FFT plug-in of ROOT is not available\n");
+	    exit(1);
+	}
+
+	plan.window = get_window_coefficients(window_, n);
+	plan.buffer.resize(n);
+	plan.window_sum = 0;
+	plan.window_square_sum = 0;
+	for (const double w : plan.window) {
+	    plan.window_sum += w;
+	    plan.window_square_sum += w * w;
+	}
+
+	it_plan = plan_list_.emplace(n, std::move(plan)).first;
+    }
+
+    Plan& plan = it_plan->second;
+
+    const double* x = g->GetX();
+    const double* y = g->GetY();
+
+    for (int i = 0; i < n; ++i) {
+	plan.buffer[i] = y[i] * plan.window[i];
+    }
+
+    plan.fft->SetPoints(plan.buffer.data());
+    plan.fft->Transform();
+
+    frequency_step = (n - 1) / ((x[n - 1] - x[0]) * n);
+
+    return plan;
+}
+
+
+TGraph* SpectrumAnalyzer::get_power_spectrum(const TGraph* g)
+{
+    double frequency_step;
+    Plan& plan = transform(g, frequency_step);
+
+    const int n = g->GetN();
+    const int n_frequency = n / 2 + 1;
+    const double norm = 1. / (frequency_step * n * plan.window_square_sum);
+
+    TGraph* g_power = new TGraph(n_frequency);
+    g_power->SetNameTitle(Form("%s_power", g->GetName()), g->GetTitle());
+    g_power->GetXaxis()->SetTitle("Frequency");
+    g_power->GetYaxis()->SetTitle("Power spectral density");
+
+    double* frequency = g_power->GetX();
+    double* power = g_power->GetY();
+
+    for (int k = 0; k < n_frequency; ++k) {
+	double re, im;
+	plan.fft->GetPointComplex(k, re, im);
+
+	const bool is_one_sided = k != 0 && !(n % 2 == 0 && k == n / 2);
+
+	frequency[k] = k * frequency_step;
+	power[k] = (re * re + im * im) * norm * (is_one_sided ? 2 : 1);
+    }
+
+    return register_in_current_scope(g_power);
+}
+
+
+std::pair<TGraph*, TGraph*> SpectrumAnalyzer::get_amplitude_phase(const TGraph* g)
+{
+    double frequency_step;
+    Plan& plan = transform(g, frequency_step);
+
+    const int n = g->GetN();
+    const int n_frequency = n / 2 + 1;
+
+    TGraph* g_amplitude = new TGraph(n_frequency);
+    g_amplitude->SetNameTitle(Form("%s_amplitude", g->GetName()), g->GetTitle());
+    g_amplitude->GetXaxis()->SetTitle("Frequency");
+    g_amplitude->GetYaxis()->SetTitle("Amplitude");
+
+    TGraph* g_phase = new TGraph(n_frequency);
+    g_phase->SetNameTitle(Form("%s_phase", g->GetName()), g->GetTitle());
+    g_phase->GetXaxis()->SetTitle("Frequency");
+    g_phase->GetYaxis()->SetTitle("Phase (rad)");
+
+    for (int k = 0; k < n_frequency; ++k) {
+	double re, im;
+	plan.fft->GetPointComplex(k, re, im);
+
+	const bool is_one_sided = k != 0 && !(n % 2 == 0 && k == n / 2);
+
+	g_amplitude->GetX()[k] = k * frequency_step;
+	g_amplitude->GetY()[k] = std::sqrt(re * re + im * im) / plan.window_sum * (is_one_sided ? 2 : 1);
+
+	g_phase->GetX()[k] = k * frequency_step;
+	g_phase->GetY()[k] = std::atan2(im, re);
+    }
+
+    return { register_in_current_scope(g_amplitude), register_in_current_scope(g_phase) };
+}
+
+
+static void register_spectrum(TGraph* g)
+{
+    register_in_current_scope(g);
+}
+
+
+static void register_spectrum(const std::pair<TGraph*, TGraph*>& g_pair)
+{
+    register_in_current_scope(g_pair.first);
+    register_in_current_scope(g_pair.second);
+}
+
+
+/**
+ * Workers have no ObjectRegistryScope, so the results are registered in the calling thread.
+ */
+template<class ResultType, class AnalysisType>
+std::vector<ResultType> analyze_spectra(const std::vector<TGraph*>& graph_list, const WindowFunction window, unsigned int n_thread, AnalysisType analysis)
+{
+    const size_t n_graph = graph_list.size();
+
+    std::vector<ResultType> result_list(n_graph);
+
+    if (n_thread == 0) n_thread = get_default_n_thread();
+    n_thread = std::max<size_t>(1, std::min<size_t>(n_thread, n_graph));
+
+    if (n_thread > 1) enable_thread_safety();
+
+    parallel_for(n_thread, [&](const size_t i_thread)
+    {
+	SpectrumAnalyzer analyzer(window);
+
+	for (size_t i_graph = i_thread; i_graph < n_graph; i_graph += n_thread) {
+	    result_list[i_graph] = analysis(analyzer, graph_list[i_graph]);
+	}
+    }, n_thread);
+
+    for (const auto& result : result_list) register_spectrum(result);
+
+    return result_list;
+}
+
+
+std::vector<TGraph*> get_power_spectrum_graphs(const std::vector<TGraph*>& graph_list, const WindowFunction window, unsigned int n_thread)
+{
+    return analyze_spectra<TGraph*>(graph_list, window, n_thread, [](SpectrumAnalyzer& analyzer, const TGraph* g)
+    {
+	return analyzer.get_power_spectrum(g);
+    });
+}
+
+
+std::vector<std::pair<TGraph*, TGraph*>> get_amplitude_phase_graphs(const std::vector<TGraph*>& graph_list, const WindowFunction window, unsigned int n_thread)
+{
+    return analyze_spectra<std::pair<TGraph*, TGraph*>>(graph_list, window, n_thread, [](SpectrumAnalyzer& analyzer, const TGraph* g)
+    {
+	return analyzer.get_amplitude_phase(g);
+    });
+}
+
+
+void EnvelopeBuilder::add(const TGraph* g)
+{
+    const size_t n = g->GetN();
+    const double* x = g->GetX();
+    const double* y = g->GetY();
+
+    if (n_graph_ == 0) {
+	x_.assign(x, x + n);
+	mean_.assign(n, 0);
+	m2_.assign(n, 0);
+	min_.assign(y, y + n);
+	max_.assign(y, y + n);
+	x_title_ = g->GetXaxis()->GetTitle();
+	y_title_ = g->GetYaxis()->GetTitle();
+
+	// Scaled by the span so that a grid point at 0 still tolerates rounding of its neighbours.
+	const auto [x_min, x_max] = std::minmax_element(x_.begin(), x_.end());
+	x_tolerance_ = n > 0 ? 1e-9 * std::max(*x_max - *x_min, std::max(std::abs(*x_min), std::abs(*x_max))) : 0;
+    } else if (n != x_.size()) {
+	fprintf(stderr, "%s has %zu points while the envelope has %zu\n", g->GetName(), n, x_.size());
+	exit(1);
+    } else {
+	for (size_t i = 0; i < n; ++i) {
+	    if (std::abs(x[i] - x_[i]) > x_tolerance_) {
+		fprintf(stderr, "%s does not share the x grid of the envelope at point %zu\n", g->GetName(), i);
+		exit(1);
+	    }
+	}
+    }
+
+    ++n_graph_;
+    const double inv_n = 1. / n_graph_;
+
+    double* __restrict mean = mean_.data();
+    double* __restrict m2 = m2_.data();
+    double* __restrict min = min_.data();
+    double* __restrict max = max_.data();
+
+    for (size_t i = 0; i < n; ++i) {
+	const double delta = y[i] - mean[i];
+	mean[i] += delta * inv_n;
+	m2[i] += delta * (y[i] - mean[i]);
+	min[i] = std::min(min[i], y[i]);
+	max[i] = std::max(max[i], y[i]);
+    }
+}
+
+
+void EnvelopeBuilder::add(const std::vector<TGraph*>& graph_list)
+{
+    for (const auto* g : graph_list) {
+	add(g);
+    }
+}
+
+
+TGraphAsymmErrors* EnvelopeBuilder::get_band_graph(const EnvelopeBand band) const
+{
+    const size_t n = x_.size();
+
+    TGraphAsymmErrors* g_band = new TGraphAsymmErrors(n);
+    g_band->GetXaxis()->SetTitle(x_title_.c_str());
+    g_band->GetYaxis()->SetTitle(y_title_.c_str());
+
+    double* x = g_band->GetX();
+    double* y = g_band->GetY();
+    double* ey_low = g_band->GetEYlow();
+    double* ey_high = g_band->GetEYhigh();
+
+    for (size_t i = 0; i < n; ++i) {
+	x[i] = x_[i];
+	y[i] = mean_[i];
+
+	switch (band) {
+	    case EnvelopeBand::MeanRMS:
+		ey_low[i] = ey_high[i] = n_graph_ > 0 ? std::sqrt(m2_[i] / n_graph_) : 0;
+		break;
+	    case EnvelopeBand::MeanStandardError:
+		ey_low[i] = ey_high[i] = n_graph_ > 1 ? std::sqrt(m2_[i] / (n_graph_ - 1) / n_graph_) : 0;
+		break;
+	    case EnvelopeBand::MinMax:
+		ey_low[i] = mean_[i] - min_[i];
+		ey_high[i] = max_[i] - mean_[i];
+		break;
+	}
     }
 
-    return g_sum;
+    return register_in_current_scope(g_band);
 }
 
 
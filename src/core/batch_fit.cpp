@@ -0,0 +1,232 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/batch_fit.h>
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/parallel.h>
+#endif
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Fit/BinData.h>
+#include <Fit/DataOptions.h>
+#include <Fit/DataRange.h>
+#include <Fit/Fitter.h>
+#include <HFitInterface.h>
+#include <Math/Factory.h>
+#include <Math/Minimizer.h>
+#include <Math/MinimizerOptions.h>
+#include <Math/WrappedMultiTF1.h>
+#include <TGraph.h>
+#include <TH1.h>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace ROOT_helper
+{
+
+
+size_t FitResultTable::get_parameter_index(const std::string& parameter_name) const
+{
+    const auto it = std::find(parameter_name_list.begin(), parameter_name_list.end(), parameter_name);
+
+    if (it == parameter_name_list.end()) {
+	fprintf(stderr, "fit result has no parameter %s\n", parameter_name.c_str());
+	exit(1);
+    }
+
+    return it - parameter_name_list.begin();
+}
+
+
+static double get_trend_x(Span<const double> x, const size_t i_object, const size_t n_object)
+{
+    if (x.empty()) return i_object;
+
+    if (x.size() != n_object) {
+	fprintf(stderr, "%zu x values given for %zu fit results\n", x.size(), n_object);
+	exit(1);
+    }
+
+    return x[i_object];
+}
+
+
+TGraphErrors* FitResultTable::get_parameter_graph(const size_t i_parameter, Span<const double> x) const
+{
+    if (i_parameter >= parameter_name_list.size()) {
+	fprintf(stderr, "fit result has no parameter %zu\n", i_parameter);
+	exit(1);
+    }
+
+    TGraphErrors* g = new TGraphErrors();
+    g->SetName(("g_fit_" + parameter_name_list[i_parameter]).c_str());
+    g->SetTitle((";;" + parameter_name_list[i_parameter]).c_str());
+
+    for (size_t i = 0; i < size(); ++i) {
+	if (status_list[i] != 0) continue;
+
+	const int i_point = g->GetN();
+	g->SetPoint(i_point, get_trend_x(x, i, size()), value_list[i_parameter][i]);
+	g->SetPointError(i_point, 0, error_list[i_parameter][i]);
+    }
+
+    return register_in_current_scope(g);
+}
+
+
+TGraphErrors* FitResultTable::get_parameter_graph(const std::string& parameter_name, Span<const double> x) const
+{
+    return get_parameter_graph(get_parameter_index(parameter_name), x);
+}
+
+
+TGraph* FitResultTable::get_chi2_ndf_graph(Span<const double> x) const
+{
+    TGraph* g = new TGraph();
+    g->SetName("g_fit_chi2_ndf");
+    g->SetTitle(";;#chi^{2}/ndf");
+
+    for (size_t i = 0; i < size(); ++i) {
+	if (status_list[i] != 0 || ndf_list[i] <= 0) continue;
+	g->SetPoint(g->GetN(), get_trend_x(x, i, size()), chi2_list[i] / ndf_list[i]);
+    }
+
+    return register_in_current_scope(g);
+}
+
+
+/**
+ * Copies limits and fixed parameters of f, following the convention of TF1::SetParLimits.
+ */
+static void set_parameter_settings(ROOT::Fit::Fitter& fitter, const TF1* f)
+{
+    for (int i = 0; i < f->GetNpar(); ++i) {
+	double low, high;
+	f->GetParLimits(i, low, high);
+
+	auto& setting = fitter.Config().ParSettings(i);
+	if (low * high != 0 && low >= high) setting.Fix();
+	else if (low < high) setting.SetLimits(low, high);
+    }
+}
+
+
+/**
+ * Returns false if the fit did not converge; f keeps the fitted parameters otherwise.
+ */
+static bool fit_object(const TObject* obj, TF1* f, const BatchFitOption& option, const std::string& minimizer_name, FitResultTable& table, const size_t i_object)
+{
+    ROOT::Fit::DataOptions data_option;
+    ROOT::Fit::DataRange range(f->GetNdim());
+    if (option.x_min < option.x_max) range.SetRange(0, option.x_min, option.x_max);
+
+    ROOT::Fit::BinData data(data_option, range);
+
+    const TH1* h = dynamic_cast<const TH1*>(obj);
+    const TGraph* g = dynamic_cast<const TGraph*>(obj);
+
+    if (h) ROOT::Fit::FillData(data, h, f);
+    else if (g) ROOT::Fit::FillData(data, g, f);
+    else {
+	fprintf(stderr, "%s of class %s cannot be fitted\n", obj->GetName(), obj->ClassName());
+	exit(1);
+    }
+
+    ROOT::Math::WrappedMultiTF1 wrapped(*f, f->GetNdim());
+
+    ROOT::Fit::Fitter fitter;
+    fitter.Config().SetMinimizer(minimizer_name.c_str());
+    fitter.SetFunction(wrapped, false);
+    set_parameter_settings(fitter, f);
+
+    const bool is_fitted = data.Size() > 0 && (h && option.is_likelihood ? fitter.LikelihoodFit(data) : fitter.Fit(data));
+    const ROOT::Fit::FitResult& result = fitter.Result();
+
+    for (int i = 0; i < f->GetNpar(); ++i) {
+	table.value_list[i][i_object] = is_fitted ? result.Parameter(i) : std::numeric_limits<double>::quiet_NaN();
+	table.error_list[i][i_object] = is_fitted ? result.ParError(i) : std::numeric_limits<double>::quiet_NaN();
+    }
+    table.chi2_list[i_object] = is_fitted ? result.Chi2() : std::numeric_limits<double>::quiet_NaN();
+    table.ndf_list[i_object] = is_fitted ? result.Ndf() : 0;
+    table.status_list[i_object] = is_fitted ? result.Status() : -1;
+
+    if (is_fitted) f->SetParameters(result.GetParams());
+
+    return is_fitted && result.Status() == 0;
+}
+
+
+static FitResultTable fit_objects(const std::vector<TObject*>& object_list, const std::vector<std::string>& name_list, const TF1* model, const BatchFitOption& option)
+{
+    const size_t n_object = object_list.size();
+    const int n_parameter = model->GetNpar();
+
+    FitResultTable table;
+    table.object_name_list = name_list;
+    for (int i = 0; i < n_parameter; ++i) table.parameter_name_list.emplace_back(model->GetParName(i));
+    table.value_list.assign(n_parameter, std::vector<double>(n_object));
+    table.error_list.assign(n_parameter, std::vector<double>(n_object));
+    table.chi2_list.resize(n_object);
+    table.ndf_list.resize(n_object);
+    table.status_list.resize(n_object);
+
+    unsigned int n_thread = option.n_thread == 0 ? get_default_n_thread() : option.n_thread;
+    n_thread = std::max<size_t>(1, std::min<size_t>(n_thread, n_object));
+
+    // Loading the plug-in once here avoids concurrent loads from the workers.
+    std::string minimizer_name = "Minuit2";
+    std::unique_ptr<ROOT::Math::Minimizer> minimizer(ROOT::Math::Factory::CreateMinimizer(minimizer_name));
+    if (!minimizer) {
+	minimizer_name = ROOT::Math::MinimizerOptions::DefaultMinimizerType();
+	n_thread = 1;
+    }
+
+    if (n_thread > 1) enable_thread_safety();
+
+    std::vector<std::unique_ptr<TF1>> f_list;
+    for (unsigned int i_thread = 0; i_thread < n_thread; ++i_thread) {
+	f_list.emplace_back(static_cast<TF1*>(model->Clone()));
+    }
+
+    parallel_for(n_thread, [&](const size_t i_thread)
+    {
+	TF1* f = f_list[i_thread].get();
+	bool is_previous_fitted = false;
+
+	for (size_t i_object = n_object * i_thread / n_thread; i_object < n_object * (i_thread + 1) / n_thread; ++i_object) {
+	    if (!option.is_seeded_from_previous || !is_previous_fitted) f->SetParameters(model->GetParameters());
+	    if (option.initialize) option.initialize(object_list[i_object], f);
+
+	    is_previous_fitted = fit_object(object_list[i_object], f, option, minimizer_name, table, i_object);
+	}
+    }, n_thread);
+
+    return table;
+}
+
+
+FitResultTable fit_objects(const std::vector<TObject*>& object_list, const TF1* model, const BatchFitOption& option)
+{
+    std::vector<std::string> name_list;
+    for (const auto* obj : object_list) name_list.emplace_back(obj->GetName());
+
+    return fit_objects(object_list, name_list, model, option);
+}
+
+
+FitResultTable fit_objects(const ObjectList& object_list, const TF1* model, const BatchFitOption& option)
+{
+    std::vector<std::string> name_list;
+    for (int i = 0; i < object_list.get_list_size(); ++i) name_list.emplace_back(object_list.get_title(i));
+
+    return fit_objects(object_list.get_object_list(), name_list, model, option);
+}
+
+
+} // namespace ROOT_helper
@@ -1,6 +1,7 @@
 #ifndef ROOT_HELPER_USED_IN_INTERPRETER
 #include <ROOT_helper/container.h>
 #include <ROOT_helper/graphics.h>
+#include <ROOT_helper/trace.h>
 #endif
 
 
@@ -11,6 +12,7 @@
 #include <THStack.h>
 #include <TMultiGraph.h>
 #include <TString.h>
+#include <TNamed.h>
 #include <TObject.h>
 #include <TDirectory.h>
 #include <cstdio>
@@ -33,6 +35,12 @@ std::vector<std::string> get_object_path_from_directories(const std::string& obj
 }
 
 
+FrameRange get_frame_range(IContainerWrapper* container)
+{
+    return container->get_frame_range();
+}
+
+
 ObjectList::ObjectList(const std::string& list_name)
 : list_name_(list_name)
 {
@@ -44,9 +52,35 @@ ObjectList::~ObjectList()
 }
 
 
+void ObjectList::add_object(TObject* obj, const std::string& title)
+{
+    push_object(obj, nullptr, obj->GetName(), title);
+}
+
+
+void ObjectList::push_object(TObject* obj, TDirectory* directory, const std::string& path, const std::string& title)
+{
+    if (!title.empty()) {
+	if (!obj->InheritsFrom(TNamed::Class())) {
+	    fprintf(stderr, "%s of class %s cannot take the title %s in %s\n", obj->GetName(), obj->ClassName(), title.c_str(), list_name_.c_str());
+	    exit(1);
+	}
+
+	static_cast<TNamed*>(obj)->SetTitle(title.c_str());
+    }
+
+    object_list_.emplace_back(obj);
+    directory_list_.emplace_back(directory);
+    path_list_.emplace_back(path);
+    title_list_.emplace_back(obj->GetTitle());
+}
+
+
 MultiObject::MultiObject(MultiObjectType object_type, const std::string& nametitle, TDirectory* directory, const std::vector<std::string>& object_name, const std::string& add_option)
 : object_type_(object_type)
 {
+    ROOT_HELPER_TRACE_SPAN("MultiObject::MultiObject");
+
     initialize_container(nametitle);
 
     const int n_obj = object_name.size();
@@ -69,6 +103,8 @@ MultiObject::MultiObject(MultiObjectType object_type, const std::string& nametit
 MultiObject::MultiObject(MultiObjectType object_type, const std::string& nametitle, const std::vector<TObject*> obj_list, const std::string& add_option)
 : object_type_(object_type)
 {
+    ROOT_HELPER_TRACE_SPAN("MultiObject::MultiObject");
+
     initialize_container(nametitle);
 
     const int n_obj = obj_list.size();
@@ -92,14 +128,36 @@ MultiObject::~MultiObject()
 }
 
 
+void MultiObject::Add(TObject* obj, const std::string& add_option)
+{
+    object_.emplace_back(obj);
+
+    container_->Add(obj, add_option);
+}
+
+
 void MultiObject::Draw(std::string option)
 {
+    ROOT_HELPER_TRACE_SPAN("MultiObject::Draw");
+
     container_->Draw(option);
 
     set_axes(container_);
 }
 
 
+void MultiObject::Draw(CanvasLayout& layout, const int i_pad, std::string option)
+{
+    ROOT_HELPER_TRACE_SPAN("MultiObject::Draw");
+
+    layout.get_canvas()->cd(i_pad);
+
+    container_->Draw(option);
+
+    layout.set_axes(i_pad, container_);
+}
+
+
 void MultiObject::initialize_container(const std::string& nametitle)
 {
     if (object_type_ == MultiObjectType::Graph) {
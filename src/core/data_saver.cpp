@@ -1,22 +1,265 @@
 #ifndef ROOT_HELPER_USED_IN_INTERPRETER
 #include <ROOT_helper/data_saver.h>
+#include <ROOT_helper/trace.h>
 #endif
 
 
+#include <cstddef>
+#include <cstring>
 #include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 #include <TCanvas.h>
 #include <TFile.h>
+#include <TGraph.h>
+#include <TH1.h>
+#include <TKey.h>
 #include <TPad.h>
 #include <TDirectory.h>
+#include <cstdio>
+#include <cstdlib>
 
 
 namespace ROOT_helper
 {
 
 
-DataSaver::DataSaver(const std::filesystem::path& base_directory, const bool is_recreate)
+/**
+ * Fields are only ever appended to index records; a record that ends early leaves the later fields empty.
+ */
+static constexpr char data_index_magic[] = "RHIDX001";
+static constexpr size_t data_index_magic_size = sizeof(data_index_magic) - 1;
+static constexpr char columnar_magic[] = "RHCOL001";
+static constexpr size_t columnar_magic_size = sizeof(columnar_magic) - 1;
+
+
+template<class T>
+static void append_binary(std::string& buffer, const T value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+
+static void append_binary(std::string& buffer, const std::string& value)
+{
+    append_binary(buffer, static_cast<uint16_t>(value.size()));
+    buffer.append(value);
+}
+
+
+template<class T>
+static bool read_binary(const char*& p, const char* end, T& value)
+{
+    if (end - p < static_cast<std::ptrdiff_t>(sizeof(T))) return false;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+
+static bool read_binary(const char*& p, const char* end, std::string& value)
+{
+    uint16_t length;
+    if (!read_binary(p, end, length) || end - p < length) return false;
+    value.assign(p, length);
+    p += length;
+    return true;
+}
+
+
+/**
+ * Columns of one object for DataSaver::write_columnar; see data_saver.h for the layout.
+ */
+class ColumnarTable
+{
+public:
+    void set_titles(const TNamed* obj, const TH1* frame)
+    {
+	title_list_ = { obj->GetName(), obj->GetTitle(), "", "", "" };
+	if (frame) {
+	    title_list_[2] = frame->GetXaxis()->GetTitle();
+	    title_list_[3] = frame->GetYaxis()->GetTitle();
+	    title_list_[4] = frame->GetZaxis()->GetTitle();
+	}
+    }
+
+    void add_column(const std::string& name, const double* data, const size_t length)
+    {
+	column_list_.push_back({ name, data, length });
+    }
+
+    std::vector<double>& add_owned_column(const std::string& name, const size_t length)
+    {
+	owned_data_list_.emplace_back(length);
+	add_column(name, owned_data_list_.back().data(), length);
+	return owned_data_list_.back();
+    }
+
+    void add_edge_column(const std::string& name, const TAxis* axis)
+    {
+	std::vector<double>& edges = add_owned_column(name, axis->GetNbins() + 1);
+	for (int bin = 1; bin <= axis->GetNbins() + 1; ++bin) edges[bin - 1] = axis->GetBinLowEdge(bin);
+    }
+
+    void write(const std::filesystem::path& file_name) const
+    {
+	std::string header(columnar_magic, columnar_magic_size);
+	append_binary(header, uint32_t(0));
+	append_binary(header, static_cast<uint32_t>(column_list_.size()));
+
+	const size_t descriptor_offset = header.size();
+	for (const auto& column : column_list_) {
+	    char name[16] = {};
+	    column.name.copy(name, sizeof(name) - 1);
+	    header.append(name, sizeof(name));
+	    append_binary(header, uint32_t(1));
+	    append_binary(header, uint32_t(0));
+	    append_binary(header, static_cast<uint64_t>(column.length));
+	    append_binary(header, uint64_t(0));
+	}
+
+	for (const auto& title : title_list_) append_binary(header, title);
+	header.resize((header.size() + 7) / 8 * 8, '\0');
+
+	const uint32_t header_length = header.size();
+	std::memcpy(&header[columnar_magic_size], &header_length, sizeof(header_length));
+
+	uint64_t offset = header_length;
+	for (size_t i = 0; i < column_list_.size(); ++i) {
+	    std::memcpy(&header[descriptor_offset + 40 * i + 32], &offset, sizeof(offset));
+	    offset += sizeof(double) * column_list_[i].length;
+	}
+
+	std::ofstream ofs(file_name, std::ios::binary | std::ios::trunc);
+	if (!ofs) {
+	    fprintf(stderr, "%s could not be opened\n", file_name.c_str());
+	    exit(1);
+	}
+
+	ofs.write(header.data(), header.size());
+	for (const auto& column : column_list_) {
+	    ofs.write(reinterpret_cast<const char*>(column.data), sizeof(double) * column.length);
+	}
+    }
+
+private:
+    struct Column
+    {
+	std::string name;
+	const double* data;
+	size_t length;
+    };
+
+    std::vector<std::string> title_list_ = std::vector<std::string>(5);
+    std::vector<Column> column_list_;
+    std::list<std::vector<double>> owned_data_list_;
+};
+
+
+DataIndex::DataIndex(const std::filesystem::path& index_file_name)
+{
+    std::ifstream ifs(index_file_name, std::ios::binary);
+
+    if (!ifs) {
+	fprintf(stderr, "%s could not be opened\n", index_file_name.c_str());
+	exit(1);
+    }
+
+    const std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+
+    if (content.compare(0, data_index_magic_size, data_index_magic) != 0) {
+	fprintf(stderr, "%s is not a data index\n", index_file_name.c_str());
+	exit(1);
+    }
+
+    const char* p = content.data() + data_index_magic_size;
+    const char* end = content.data() + content.size();
+
+    for (;;) {
+	uint32_t record_length;
+	if (!read_binary(p, end, record_length) || static_cast<size_t>(end - p) < record_length) break;
+
+	const char* record_end = p + record_length;
+
+	DataIndexEntry record;
+	const bool is_valid = read_binary(p, record_end, record.seek_key)
+	    && read_binary(p, record_end, record.n_byte)
+	    && read_binary(p, record_end, record.key_length)
+	    && read_binary(p, record_end, record.object_length)
+	    && read_binary(p, record_end, record.path)
+	    && read_binary(p, record_end, record.class_name)
+	    && read_binary(p, record_end, record.pdf_path)
+	    && read_binary(p, record_end, record.png_path)
+	    && (p == record_end || read_binary(p, record_end, record.columnar_path));
+
+	p = record_end;
+	if (!is_valid) continue;
+
+	DataIndexEntry& entry = entry_map_[record.path];
+	entry.path = record.path;
+	entry.class_name = record.class_name;
+
+	if (record.seek_key >= 0) {
+	    entry.seek_key = record.seek_key;
+	    entry.n_byte = record.n_byte;
+	    entry.key_length = record.key_length;
+	    entry.object_length = record.object_length;
+	}
+
+	if (!record.pdf_path.empty()) entry.pdf_path = record.pdf_path;
+	if (!record.png_path.empty()) entry.png_path = record.png_path;
+	if (!record.columnar_path.empty()) entry.columnar_path = record.columnar_path;
+    }
+}
+
+
+std::filesystem::path DataIndex::get_index_file_name(const std::filesystem::path& data_file_name)
+{
+    return data_file_name.string() + ".index";
+}
+
+
+const DataIndexEntry* DataIndex::find(const std::string& path) const
+{
+    const auto it = entry_map_.find(path);
+    return it == entry_map_.end() ? nullptr : &it->second;
+}
+
+
+TObject* DataIndex::read_object(TFile* f, const std::string& path) const
+{
+    const DataIndexEntry* entry = find(path);
+
+    if (!entry || entry->seek_key < 0) {
+	fprintf(stderr, "%s is not in the data index\n", path.c_str());
+	exit(1);
+    }
+
+    std::vector<char> key_buffer(entry->key_length);
+    if (f->ReadBuffer(key_buffer.data(), entry->seek_key, entry->key_length)) {
+	fprintf(stderr, "key of %s could not be read from %s\n", path.c_str(), f->GetName());
+	exit(1);
+    }
+
+    TKey key(f);
+    char* p = key_buffer.data();
+    key.ReadKeyBuffer(p);
+
+    // ReadObj attaches histograms to the root directory of f, which may be closed before they are used.
+    TObject* obj = key.ReadObj();
+    if (auto* h = dynamic_cast<TH1*>(obj)) h->SetDirectory(nullptr);
+
+    return obj;
+}
+
+
+DataSaver::DataSaver(const std::filesystem::path& base_directory, const bool is_recreate, const std::string& data_file_name)
 : base_directory_(base_directory)
 {
     std::filesystem::create_directories(base_directory_);
@@ -24,7 +267,19 @@ DataSaver::DataSaver(const std::filesystem::path& base_directory, const bool is_
     std::string open_mode = "UPDATE";
     if (is_recreate) open_mode = "RECREATE";
 
-    f_write_ = std::make_unique<TFile>((base_directory / "data.root").c_str(), open_mode.c_str());
+    // An index left over from a deleted data file would point into the new one.
+    const bool is_new_file = is_recreate || !std::filesystem::exists(base_directory / data_file_name);
+
+    f_write_ = std::make_unique<TFile>((base_directory / data_file_name).c_str(), open_mode.c_str());
+
+    const std::filesystem::path index_file_name = DataIndex::get_index_file_name(base_directory / data_file_name);
+
+    if (is_new_file || !std::filesystem::exists(index_file_name)) {
+	index_stream_.open(index_file_name, std::ios::binary | std::ios::trunc);
+	index_stream_.write(data_index_magic, data_index_magic_size);
+    } else {
+	index_stream_.open(index_file_name, std::ios::binary | std::ios::app);
+    }
 }
 
 
@@ -36,6 +291,10 @@ DataSaver::~DataSaver()
 
 void DataSaver::write_canvas(TCanvas* c, const std::filesystem::path& relative_save_directory) const
 {
+    ROOT_HELPER_TRACE_SPAN("DataSaver::write_canvas");
+
+    std::lock_guard<std::recursive_mutex> lock(get_output_mutex());
+
     write_canvas_without_data_saving(c, relative_save_directory);
 
     save_object(c, relative_save_directory);
@@ -44,15 +303,18 @@ void DataSaver::write_canvas(TCanvas* c, const std::filesystem::path& relative_s
 
 void DataSaver::write_canvas_without_data_saving(TCanvas* c, const std::filesystem::path& relative_save_directory) const
 {
-    gPad->Update();
+    ROOT_HELPER_TRACE_SPAN("DataSaver::write_canvas_without_data_saving");
 
-    const std::filesystem::path write_directory = base_directory_ / relative_save_directory;
+    std::lock_guard<std::recursive_mutex> lock(get_output_mutex());
 
-    c->Print(Form("%s.pdf", (write_directory / c->GetName()).c_str()));
+    print_canvas(c, base_directory_ / relative_save_directory);
 
-    std::filesystem::path png_save_directory = write_directory / "png";
-    std::filesystem::create_directories(png_save_directory);
-    c->Print(Form("%s.png", (png_save_directory / c->GetName()).c_str()));
+    DataIndexEntry entry;
+    entry.path = (relative_save_directory / c->GetName()).string();
+    entry.class_name = c->ClassName();
+    entry.pdf_path = (relative_save_directory / (std::string(c->GetName()) + ".pdf")).string();
+    entry.png_path = (relative_save_directory / "png" / (std::string(c->GetName()) + ".png")).string();
+    append_index_entry(entry);
 }
 
 
@@ -64,6 +326,128 @@ std::filesystem::path DataSaver::create_directories(const std::filesystem::path&
 }
 
 
+void DataSaver::print_canvas(TCanvas* c, const std::filesystem::path& write_directory)
+{
+    std::lock_guard<std::recursive_mutex> lock(get_output_mutex());
+
+    {
+	ROOT_HELPER_TRACE_SPAN("TPad::Update");
+	gPad->Update();
+    }
+
+    {
+	ROOT_HELPER_TRACE_SPAN("TCanvas::Print pdf");
+	c->Print(Form("%s.pdf", (write_directory / c->GetName()).c_str()));
+    }
+
+    std::filesystem::path png_save_directory = write_directory / "png";
+    std::filesystem::create_directories(png_save_directory);
+
+    {
+	ROOT_HELPER_TRACE_SPAN("TCanvas::Print png");
+	c->Print(Form("%s.png", (png_save_directory / c->GetName()).c_str()));
+    }
+}
+
+
+std::recursive_mutex& DataSaver::get_output_mutex()
+{
+    static std::recursive_mutex output_mutex;
+    return output_mutex;
+}
+
+
+void DataSaver::write_object(TObject* obj, const std::filesystem::path& relative_save_directory) const
+{
+    obj->Write("", TObject::kOverwrite);
+
+    const TKey* key = gDirectory->GetKey(obj->GetName());
+    if (!key) return;
+
+    DataIndexEntry entry;
+    entry.path = (relative_save_directory / obj->GetName()).string();
+    entry.class_name = obj->ClassName();
+    entry.seek_key = key->GetSeekKey();
+    entry.n_byte = key->GetNbytes();
+    entry.key_length = key->GetKeylen();
+    entry.object_length = key->GetObjlen();
+    if (is_columnar_export_) entry.columnar_path = write_columnar(obj, relative_save_directory);
+    append_index_entry(entry);
+}
+
+
+void DataSaver::append_index_entry(const DataIndexEntry& entry) const
+{
+    std::string record;
+    append_binary(record, entry.seek_key);
+    append_binary(record, entry.n_byte);
+    append_binary(record, entry.key_length);
+    append_binary(record, entry.object_length);
+    append_binary(record, entry.path);
+    append_binary(record, entry.class_name);
+    append_binary(record, entry.pdf_path);
+    append_binary(record, entry.png_path);
+    append_binary(record, entry.columnar_path);
+
+    const uint32_t record_length = record.size();
+    index_stream_.write(reinterpret_cast<const char*>(&record_length), sizeof(record_length));
+    index_stream_.write(record.data(), record.size());
+    index_stream_.flush();
+}
+
+
+std::string DataSaver::write_columnar(const TObject* obj, const std::filesystem::path& relative_save_directory) const
+{
+    ROOT_HELPER_TRACE_SPAN("DataSaver::write_columnar");
+
+    ColumnarTable table;
+
+    if (const auto* g = dynamic_cast<const TGraph*>(obj)) {
+	table.set_titles(g, g->GetHistogram());
+	const size_t n = g->GetN();
+
+	table.add_column("x", g->GetX(), n);
+	table.add_column("y", g->GetY(), n);
+
+	if (g->GetEX() && g->GetEY()) {
+	    table.add_column("ex", g->GetEX(), n);
+	    table.add_column("ey", g->GetEY(), n);
+	} else if (g->GetEXlow() && g->GetEYlow()) {
+	    table.add_column("exl", g->GetEXlow(), n);
+	    table.add_column("exh", g->GetEXhigh(), n);
+	    table.add_column("eyl", g->GetEYlow(), n);
+	    table.add_column("eyh", g->GetEYhigh(), n);
+	}
+    } else if (const auto* h = dynamic_cast<const TH1*>(obj); h && h->GetDimension() <= 2) {
+	table.set_titles(h, h);
+
+	const int n_x = h->GetNbinsX();
+	const int n_y = h->GetDimension() == 2 ? h->GetNbinsY() : 1;
+
+	table.add_edge_column("x_edges", h->GetXaxis());
+	if (h->GetDimension() == 2) table.add_edge_column("y_edges", h->GetYaxis());
+
+	std::vector<double>& content = table.add_owned_column("content", n_x * n_y);
+	std::vector<double>& error = table.add_owned_column("error", n_x * n_y);
+	for (int i_y = 0; i_y < n_y; ++i_y) {
+	    for (int i_x = 0; i_x < n_x; ++i_x) {
+		const int bin = h->GetDimension() == 2 ? h->GetBin(i_x + 1, i_y + 1) : i_x + 1;
+		content[i_x + n_x * i_y] = h->GetBinContent(bin);
+		error[i_x + n_x * i_y] = h->GetBinError(bin);
+	    }
+	}
+    } else {
+	return "";
+    }
+
+    const std::filesystem::path relative_path = relative_save_directory / "columnar" / (std::string(obj->GetName()) + ".rhcol");
+    std::filesystem::create_directories((base_directory_ / relative_path).parent_path());
+    table.write(base_directory_ / relative_path);
+
+    return relative_path.string();
+}
+
+
 void DataSaver::create_and_change_directory(const std::filesystem::path& relative_save_directory) const
 {
     std::filesystem::create_directories(base_directory_ / relative_save_directory);
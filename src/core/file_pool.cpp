@@ -0,0 +1,152 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/file_pool.h>
+#include <ROOT_helper/trace.h>
+#endif
+
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TGraph2D.h>
+#include <TH1.h>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace ROOT_helper
+{
+
+
+std::pair<std::string, std::string> split_object_spec(const std::string& spec)
+{
+    const size_t i_separator = spec.rfind(':');
+
+    if (i_separator == std::string::npos || i_separator == 0 || i_separator + 1 == spec.size()) {
+	fprintf(stderr, "%s is not of the form file:path\n", spec.c_str());
+	exit(1);
+    }
+
+    return { spec.substr(0, i_separator), spec.substr(i_separator + 1) };
+}
+
+
+FilePool::FilePool(const size_t max_n_open)
+: max_n_open_(std::max<size_t>(1, max_n_open))
+{
+}
+
+
+FilePool::~FilePool()
+{
+    close_all();
+}
+
+
+TFile* FilePool::get_file(const std::filesystem::path& file_name)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+    const std::string key = file_name.string();
+
+    const auto it = file_map_.find(key);
+    if (it != file_map_.end()) {
+	lru_list_.splice(lru_list_.begin(), lru_list_, it->second.lru_it);
+	++stats_.n_reuse;
+	return it->second.f.get();
+    }
+
+    while (file_map_.size() >= max_n_open_) close_least_recently_used();
+
+    ROOT_HELPER_TRACE_SPAN("FilePool::open");
+    TDirectory::TContext context;
+
+    std::unique_ptr<TFile> f(TFile::Open(key.c_str(), "READ"));
+
+    if (!f || f->IsZombie()) {
+	fprintf(stderr, "%s could not be opened\n", key.c_str());
+	exit(1);
+    }
+
+    ++stats_.n_open;
+
+    lru_list_.push_front(key);
+    TFile* f_raw = f.get();
+    file_map_.emplace(key, Entry { std::move(f), lru_list_.begin() });
+
+    return f_raw;
+}
+
+
+TObject* FilePool::read_object(const std::string& spec)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+    const auto [file_name, path] = split_object_spec(spec);
+
+    TFile* f = get_file(file_name);
+    TObject* obj = f->Get(path.c_str());
+
+    if (!obj) {
+	fprintf(stderr, "%s was not found in %s\n", path.c_str(), file_name.c_str());
+	exit(1);
+    }
+
+    if (auto* h = dynamic_cast<TH1*>(obj)) h->SetDirectory(nullptr);
+    else if (auto* g = dynamic_cast<TGraph2D*>(obj)) g->SetDirectory(nullptr);
+
+    return obj;
+}
+
+
+void FilePool::set_max_n_open(const size_t max_n_open)
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+    max_n_open_ = std::max<size_t>(1, max_n_open);
+    while (file_map_.size() > max_n_open_) close_least_recently_used();
+}
+
+
+size_t FilePool::get_n_open() const
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return file_map_.size();
+}
+
+
+FilePoolStats FilePool::get_stats() const
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    return stats_;
+}
+
+
+void FilePool::close_all()
+{
+    std::lock_guard<std::recursive_mutex> lock(mutex_);
+    while (!file_map_.empty()) close_least_recently_used();
+}
+
+
+void FilePool::close_least_recently_used()
+{
+    file_map_.erase(lru_list_.back());
+    lru_list_.pop_back();
+    ++stats_.n_close;
+}
+
+
+FilePool& FilePool::get_global()
+{
+    static FilePool pool;
+    return pool;
+}
+
+
+} // namespace ROOT_helper
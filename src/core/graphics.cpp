@@ -3,20 +3,34 @@
 #endif
 
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <mutex>
 #include <regex>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
 #include <utility>
 
 #include <TCanvas.h>
-#include <TF1.h>
 #include <TGraph.h>
 #include <TMultiGraph.h>
+#include <THStack.h>
+#include <TH1.h>
+#include <TObjArray.h>
 #include <TLegend.h>
 #include <TLatex.h>
 #include <TLine.h>
-#include <TSpline.h>
 #include <TStyle.h>
 #include <TPad.h>
+#include <TROOT.h>
 #include <TList.h>
+#include <TText.h>
+#include <THLimitsFinder.h>
+#include <cstdio>
+#include <cstdlib>
 
 
 namespace ROOT_helper
@@ -26,13 +40,76 @@ namespace ROOT_helper
 GraphicsSize GraphicsSize::current = g_size_8pt;
 
 
+static GraphicsSize*& get_bound_size()
+{
+    static ROOT_HELPER_THREAD_LOCAL GraphicsSize* bound_size = nullptr;
+    return bound_size;
+}
+
+
+GraphicsSize& get_current_graphics_size()
+{
+    GraphicsSize* bound_size = get_bound_size();
+    return bound_size ? *bound_size : GraphicsSize::current;
+}
+
+
+static TLatex*& get_bound_latex()
+{
+    static ROOT_HELPER_THREAD_LOCAL TLatex* bound_latex = nullptr;
+    return bound_latex;
+}
+
+
+TLatex& get_latex_template()
+{
+    static TLatex latex;
+
+    TLatex* bound_latex = get_bound_latex();
+    return bound_latex ? *bound_latex : latex;
+}
+
+
 void prepare()
 {
     gStyle->SetOptStat(0);
     gStyle->SetOptFit(0);
     gStyle->SetOptTitle(0);
 
-    kLatex.SetTextSize(GraphicsSize::current.text_size * 0.8);
+    get_latex_template().SetTextSize(get_current_graphics_size().text_size * 0.8);
+}
+
+
+GraphicsContext::GraphicsContext(const GraphicsSize& size)
+: size(size)
+{
+    latex.SetTextSize(size.text_size * 0.8);
+}
+
+
+GraphicsContextBinding::GraphicsContextBinding(GraphicsContext& context)
+: context_(context), size_saved_(get_bound_size()), latex_saved_(get_bound_latex()), pad_saved_(gPad)
+{
+    get_bound_size() = &context_.size;
+    get_bound_latex() = &context_.latex;
+    if (context_.pad) context_.pad->cd();
+}
+
+
+GraphicsContextBinding::~GraphicsContextBinding()
+{
+    context_.pad = gPad;
+
+    get_bound_size() = size_saved_;
+    get_bound_latex() = latex_saved_;
+    gPad = pad_saved_;
+}
+
+
+void enable_parallel_graphics(const bool is_batch)
+{
+    enable_thread_safety();
+    if (is_batch) gROOT->SetBatch(kTRUE);
 }
 
 
@@ -77,6 +154,141 @@ TCanvas* create_canvas_with_default_pad_matrix(const std::string& name, const st
 }
 
 
+struct PooledCanvasRegistry
+{
+    std::mutex mutex;
+    std::map<const TCanvas*, ObjectRegistry*> registry_map;
+};
+
+
+static PooledCanvasRegistry& get_pooled_canvas_registry()
+{
+    static PooledCanvasRegistry registry;
+    return registry;
+}
+
+
+CanvasPool::~CanvasPool()
+{
+    for (auto& [ c, pooled ] : canvas_list_) {
+	{
+	    PooledCanvasRegistry& registry = get_pooled_canvas_registry();
+	    std::lock_guard<std::mutex> lock(registry.mutex);
+	    registry.registry_map.erase(c);
+	}
+	pooled.registry->clear();
+	delete c;
+    }
+}
+
+
+TCanvas* CanvasPool::acquire(const std::string& name, const std::string& title, const unsigned int n_pad_x, const unsigned int n_pad_y, const unsigned int each_size_x, const unsigned int each_size_y)
+{
+    const Geometry geometry { n_pad_x, n_pad_y, each_size_x, each_size_y };
+
+    std::vector<TCanvas*>& free_canvas_list = free_list_[geometry];
+
+    if (!free_canvas_list.empty()) {
+	TCanvas* c = free_canvas_list.back();
+	free_canvas_list.pop_back();
+
+	c->SetName(name.c_str());
+	c->SetTitle(title.c_str());
+	c->cd();
+
+	++n_reused_;
+
+	return c;
+    }
+
+    TCanvas* c = create_canvas(name, title, n_pad_x, n_pad_y, each_size_x, each_size_y);
+
+    PooledCanvas pooled { geometry, {}, std::make_unique<ObjectRegistry>() };
+    for (unsigned int i_pad = 0; i_pad <= n_pad_x * n_pad_y; ++i_pad) {
+	TVirtualPad* pad = c->GetPad(i_pad);
+	if (!pad) continue;
+	pooled.pad_state_list.push_back({
+	    pad,
+	    pad->GetTopMargin(), pad->GetRightMargin(), pad->GetBottomMargin(), pad->GetLeftMargin(),
+	    pad->GetLogx(), pad->GetLogy(), pad->GetLogz()
+	});
+    }
+    ObjectRegistry* object_registry = pooled.registry.get();
+    canvas_list_.emplace(c, std::move(pooled));
+
+    {
+	PooledCanvasRegistry& registry = get_pooled_canvas_registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+	registry.registry_map.emplace(c, object_registry);
+    }
+
+    c->cd();
+
+    ++n_created_;
+
+    return c;
+}
+
+
+/**
+ * The canvas gets a placeholder name so that a new TCanvas with its former name does not delete it.
+ */
+void CanvasPool::release(TCanvas* c)
+{
+    auto it = canvas_list_.find(c);
+
+    if (it == canvas_list_.end()) {
+	fprintf(stderr, "%s was not acquired from this canvas pool\n", c->GetName());
+	exit(1);
+    }
+
+    PooledCanvas& pooled = it->second;
+
+    pooled.registry->clear();
+
+    if (pooled.geometry.n_pad_x > 1 || pooled.geometry.n_pad_y > 1) {
+	c->Clear("D");
+    } else {
+	c->Clear();
+    }
+
+    for (const auto& state : pooled.pad_state_list) {
+	state.pad->SetMargin(state.left_margin, state.right_margin, state.bottom_margin, state.top_margin);
+	state.pad->SetLogx(state.logx);
+	state.pad->SetLogy(state.logy);
+	state.pad->SetLogz(state.logz);
+	state.pad->Modified();
+    }
+
+    c->SetName(Form("canvas_pool_%p", static_cast<void*>(c)));
+
+    free_list_[pooled.geometry].push_back(c);
+}
+
+
+bool CanvasPool::is_pooled(const TCanvas* c)
+{
+    return get_registry(c) != nullptr;
+}
+
+
+ObjectRegistry* CanvasPool::get_registry(const TCanvas* c)
+{
+    PooledCanvasRegistry& registry = get_pooled_canvas_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    auto it = registry.registry_map.find(c);
+    return it != registry.registry_map.end() ? it->second : nullptr;
+}
+
+
+void own_helper_object(TObject* obj)
+{
+    ObjectRegistry* registry = gPad ? CanvasPool::get_registry(gPad->GetCanvas()) : nullptr;
+    if (!registry) registry = ObjectRegistry::get_current();
+    if (registry) registry->add(obj);
+}
+
+
 Color_t get_color_in_ring(const unsigned int index)
 {
     switch (index)
@@ -94,7 +306,7 @@ Color_t get_color_in_ring(const unsigned int index)
 double increase_top_margin(const double scale)
 {
     const double current = gPad->GetTopMargin();
-    const double next = std::max(0., current + scale * GraphicsSize::current.margin_step_vertcical);
+    const double next = std::max(0., current + scale * get_current_graphics_size().margin_step_vertcical);
 
     gPad->SetTopMargin(next);
 
@@ -105,7 +317,7 @@ double increase_top_margin(const double scale)
 double increase_right_margin(const double scale)
 {
     const double current = gPad->GetRightMargin();
-    const double next = std::max(0., current + scale * GraphicsSize::current.margin_step_horizontal);
+    const double next = std::max(0., current + scale * get_current_graphics_size().margin_step_horizontal);
 
     gPad->SetRightMargin(next);
 
@@ -113,45 +325,506 @@ double increase_right_margin(const double scale)
 }
 
 
-TLegend* put_legend(LegendPosition leg_pos, Option_t* option, const double width, const double height)
+struct TextExtentKey
 {
-    gPad->Update();
+    Font_t font;
+    double size;
+    double pixel_scale;
+    std::string text;
+
+    bool operator==(const TextExtentKey& other) const
+    {
+	return font == other.font && size == other.size && pixel_scale == other.pixel_scale && text == other.text;
+    }
+};
+
+
+struct TextExtentKeyHash
+{
+    size_t operator()(const TextExtentKey& key) const
+    {
+	size_t h = std::hash<std::string>()(key.text);
+	h ^= std::hash<double>()(key.size) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	h ^= std::hash<double>()(key.pixel_scale) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	h ^= std::hash<int>()(key.font) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	return h;
+    }
+};
+
+
+struct AxisLimitsKey
+{
+    double x_min;
+    double x_max;
+    int n_division;
+
+    bool operator==(const AxisLimitsKey& other) const
+    {
+	return x_min == other.x_min && x_max == other.x_max && n_division == other.n_division;
+    }
+};
+
+
+struct AxisLimitsKeyHash
+{
+    size_t operator()(const AxisLimitsKey& key) const
+    {
+	size_t h = std::hash<double>()(key.x_min);
+	h ^= std::hash<double>()(key.x_max) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	h ^= std::hash<int>()(key.n_division) + 0x9e3779b9 + (h << 6) + (h >> 2);
+	return h;
+    }
+};
+
+
+struct AxisLimits
+{
+    double bin_low;
+    double bin_high;
+    int n_bin;
+    double bin_width;
+};
+
+
+struct LayoutCache
+{
+    static constexpr size_t max_entry = 1 << 16;
 
-    const Double_t top_edge = 1.0 - gPad->GetTopMargin() - 0.02;
-    const Double_t right_edge = 1.0 - gPad->GetRightMargin() - 0.02;
-    const Double_t bottom_edge = gPad->GetBottomMargin() + 0.02;
-    const Double_t left_edge = gPad->GetLeftMargin() + 0.02;
+    std::mutex mutex;
+    std::unordered_map<TextExtentKey, std::pair<UInt_t, UInt_t>, TextExtentKeyHash> text_extent;
+    std::unordered_map<AxisLimitsKey, AxisLimits, AxisLimitsKeyHash> limits;
+    LayoutCacheStats stats {};
+};
 
-    TLegend* leg;
+
+static LayoutCache& get_layout_cache()
+{
+    static LayoutCache cache;
+    return cache;
+}
+
+
+LayoutCacheStats get_layout_cache_stats()
+{
+    LayoutCache& cache = get_layout_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.stats;
+}
+
+
+void clear_layout_cache()
+{
+    LayoutCache& cache = get_layout_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.text_extent.clear();
+    cache.limits.clear();
+    cache.stats = LayoutCacheStats {};
+}
+
+
+/**
+ * TText::GetTextExtent scales relative sizes of non-pixel fonts by the smaller pixel dimension of gPad,
+ * so that dimension is part of the key. Measurements go through the global TTF state and are serialized.
+ */
+std::pair<UInt_t, UInt_t> get_text_extent(const Font_t font, const double size, const std::string& text)
+{
+    double pixel_scale = 0;
+    if (font % 10 <= 2 && gPad) {
+	const double w = gPad->XtoPixel(gPad->GetX2());
+	const double h = gPad->YtoPixel(gPad->GetY1());
+	pixel_scale = std::min(w, h);
+    }
+
+    const TextExtentKey key { font, size, pixel_scale, text };
+
+    LayoutCache& cache = get_layout_cache();
+
+    {
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	auto it = cache.text_extent.find(key);
+	if (it != cache.text_extent.end()) {
+	    ++cache.stats.text_extent_hit;
+	    return it->second;
+	}
+    }
+
+    UInt_t w, h;
+
+    {
+	static std::mutex font_mutex;
+	std::lock_guard<std::mutex> font_lock(font_mutex);
+
+	TText t;
+	t.SetTextFont(font);
+	t.SetTextSize(size);
+	t.GetTextExtent(w, h, text.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    ++cache.stats.text_extent_miss;
+    if (cache.text_extent.size() >= LayoutCache::max_entry) cache.text_extent.clear();
+    cache.text_extent.emplace(key, std::make_pair(w, h));
+
+    return { w, h };
+}
+
+
+void optimize_axis_limits(const double x_min, const double x_max, const int n_division, double& bin_low, double& bin_high, int& n_bin, double& bin_width)
+{
+    const AxisLimitsKey key { x_min, x_max, n_division };
+
+    LayoutCache& cache = get_layout_cache();
+
+    {
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	auto it = cache.limits.find(key);
+	if (it != cache.limits.end()) {
+	    ++cache.stats.limits_hit;
+	    bin_low = it->second.bin_low;
+	    bin_high = it->second.bin_high;
+	    n_bin = it->second.n_bin;
+	    bin_width = it->second.bin_width;
+	    return;
+	}
+    }
+
+    THLimitsFinder::Optimize(x_min, x_max, n_division, bin_low, bin_high, n_bin, bin_width, "");
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    ++cache.stats.limits_miss;
+    if (cache.limits.size() >= LayoutCache::max_entry) cache.limits.clear();
+    cache.limits.emplace(key, AxisLimits { bin_low, bin_high, n_bin, bin_width });
+}
+
+
+double GetMaxLabelWidthNDC(TAxis* axis) {
+  if (!axis) return 0.0;
+
+  return get_max_label_width_ndc(axis, axis->GetXmin(), axis->GetXmax());
+}
+
+
+/**
+ * Same as GetMaxLabelWidthNDC for an axis range that has not been painted yet.
+ */
+double get_max_label_width_ndc(TAxis* axis, const double xmin, const double xmax) {
+  if (!axis || !gPad) return 0.0;
+
+  // 1. Handle Alphanumeric Labels (e.g., "Jan", "Feb")
+  if (axis->GetLabels()) {
+    UInt_t maxW = 0;
+    TIter next(axis->GetLabels());
+    TObject *obj;
+    while ((obj = next())) {
+      const UInt_t w = get_text_extent(axis->GetLabelFont(), axis->GetLabelSize(), obj->GetName()).first;
+      if (w > maxW) maxW = w;
+    }
+    return (double)maxW / (gPad->GetWw() * gPad->GetWNDC());
+  }
+
+  // 2. Numerical Labels - Query ROOT's Optimization Engine
+  int nDivCode = axis->GetNdivisions();
+  int nPrimary = std::abs(nDivCode) % 100;
+
+  double binLow, binHigh, binWidth;
+  int nbins;
+
+  // Check if the user forced divisions (nDivCode < 0 disables optimization)
+  if (nDivCode > 0) {
+    // THIS is the secret sauce ROOT uses to find the "pretty" numbers
+    optimize_axis_limits(xmin, xmax, nPrimary, binLow, binHigh, nbins, binWidth);
+  } else {
+    // Strict, unoptimized mathematical division
+    binLow = xmin;
+    binHigh = xmax;
+    nbins = nPrimary;
+    binWidth = (xmax - xmin) / (double)nbins;
+  }
+
+  // 3. Measure the exact labels ROOT will generate
+  UInt_t maxW = 0;
+  int maxDigits = TGaxis::GetMaxDigits();
+
+  for (int i = 0; i <= nbins; ++i) {
+    double val = binLow + i * binWidth;
+    if (std::abs(val) < 1e-10) val = 0.0; // Clean up floating point dust
+
+    TString s;
+    // Mimic ROOT's Scientific Notation switch (e.g., pulling out x10^N)
+    if (val != 0 && (std::abs(val) >= std::pow(10, maxDigits) || std::abs(val) < std::pow(10, -maxDigits))) {
+      int exp = (int)std::floor(std::log10(std::abs(val)));
+      double base = val / std::pow(10, exp);
+      s.Form("%g", base); 
+    } else {
+      s.Form("%g", val);
+    }
+
+    const UInt_t w = get_text_extent(axis->GetLabelFont(), axis->GetLabelSize(), s.Data()).first;
+    if (w > maxW) maxW = w;
+  }
+
+  return (double)maxW / (gPad->GetWw() * gPad->GetWNDC());
+}
+
+void OptimizeYAxisLayout(TAxis *yAxis) {
+  if (!yAxis || !gPad) return;
+
+  apply_y_axis_layout(yAxis, GetMaxLabelWidthNDC(yAxis));
+}
+
+
+void apply_y_axis_layout(TAxis *yAxis, const double labelWidth) {
+  if (!yAxis || !gPad) return;
+
+  // 2. Fetch current axis properties
+  double tickLength = yAxis->GetTickLength(); // Usually ~0.03
+  double titleSize = yAxis->GetTitleSize();   // Usually ~0.04
+
+  // 3. Calculate the required distance from the axis line
+  // We need space for the ticks, the widest label, and a small visual gap.
+  double gap = 0.010; // 1.5% of pad width for breathing room
+  double distanceFromAxis = tickLength + labelWidth + gap;
+
+  // 4. Calculate and set the Title Offset
+  // Since TitleOffset is a multiplier based on TitleSize, we divide our 
+  // required distance by the TitleSize. The 0.85 is an empirical ROOT tuning 
+  // factor to center the text perfectly.
+  double titleOffset = (distanceFromAxis / titleSize) * 0.70;
+  yAxis->SetTitleOffset(titleOffset);
+
+  // 5. Calculate and set the Left Margin
+  // The margin must fit everything above PLUS the title text itself, 
+  // otherwise the title gets cut off by the edge of the window.
+  double leftEdgeBuffer = 0.000; // Keep it slightly away from the absolute window edge
+  double requiredMargin = distanceFromAxis + titleSize + leftEdgeBuffer;
+
+  // Update the margin (ensure we don't shrink it if it was already intentionally large)
+  if (gPad->GetLeftMargin() < requiredMargin) {
+    gPad->SetLeftMargin(requiredMargin);
+  }
+}
+
+double GetYaxisLabelWidthNDC(IContainerWrapper *obj) {
+  return 0;
+}
+
+
+/**
+ * Point counts on a coarse grid over the frame, queried through a summed-area table.
+ * Objects are sampled with a stride so that each contributes at most n_max_sample points.
+ */
+class OccupancyGrid
+{
+public:
+    static constexpr int n_cell = 32;
+    static constexpr size_t n_max_sample = 2048;
+
+    OccupancyGrid(TVirtualPad* pad, const FrameRange& range)
+    : is_logx_(pad->GetLogx()), is_logy_(pad->GetLogy()),
+      x_min_(to_pad(range.x_min, is_logx_)), x_max_(to_pad(range.x_max, is_logx_)),
+      y_min_(to_pad(range.y_min, is_logy_)), y_max_(to_pad(range.y_max, is_logy_)),
+      count_(n_cell * n_cell, 0)
+    {
+    }
+
+    void fill(const double x, const double y)
+    {
+	const double fx = (to_pad(x, is_logx_) - x_min_) / (x_max_ - x_min_);
+	const double fy = (to_pad(y, is_logy_) - y_min_) / (y_max_ - y_min_);
+
+	if (!(fx >= 0 && fx < 1 && fy >= 0 && fy < 1)) return;
+
+	++count_[static_cast<int>(fy * n_cell) * n_cell + static_cast<int>(fx * n_cell)];
+    }
+
+    void fill(const TGraph* g)
+    {
+	const size_t n = g->GetN();
+	const size_t stride = std::max<size_t>(1, (n + n_max_sample - 1) / n_max_sample);
+	const double* x = g->GetX();
+	const double* y = g->GetY();
+
+	for (size_t i = 0; i < n; i += stride) fill(x[i], y[i]);
+    }
+
+    void fill(const TH1* h)
+    {
+	if (h->GetDimension() != 1) return;
+
+	const size_t n = h->GetNbinsX();
+	const size_t stride = std::max<size_t>(1, (n + n_max_sample - 1) / n_max_sample);
+	const TAxis* axis = h->GetXaxis();
+
+	for (size_t i = 1; i <= n; i += stride) fill(axis->GetBinCenter(i), h->GetBinContent(i));
+    }
+
+    /**
+     * Graphs and histograms are taken from the pad primitives, multigraphs and stacks.
+     * A stack contributes its cumulative sums only if it was drawn stacked, i.e. without "nostack" in its draw option.
+     */
+    void fill(const TList* primitive_list)
+    {
+	for (const TObjLink* link = primitive_list->FirstLink(); link; link = link->Next()) {
+	    const TObject* obj = link->GetObject();
+
+	    if (const auto* g = dynamic_cast<const TGraph*>(obj)) {
+		fill(g);
+	    } else if (const auto* h = dynamic_cast<const TH1*>(obj)) {
+		fill(h);
+	    } else if (const auto* mg = dynamic_cast<const TMultiGraph*>(obj)) {
+		if (mg->GetListOfGraphs()) fill(mg->GetListOfGraphs());
+	    } else if (const auto* stack = dynamic_cast<const THStack*>(obj)) {
+		const bool is_stacked = !TString(link->GetOption()).Contains("nostack", TString::kIgnoreCase);
+		TObjArray* stacked = is_stacked ? const_cast<THStack*>(stack)->GetStack() : nullptr;
+		if (stacked) {
+		    for (const TObject* h : *stacked) fill(static_cast<const TH1*>(h));
+		} else if (stack->GetHists()) {
+		    fill(stack->GetHists());
+		}
+	    }
+	}
+    }
+
+    /**
+     * Points in the box given in fractions of the frame.
+     */
+    unsigned long count(const double fx1, const double fy1, const double fx2, const double fy2)
+    {
+	if (sum_.empty()) build_sum();
+
+	const int ix1 = to_cell(fx1); const int ix2 = to_cell(fx2);
+	const int iy1 = to_cell(fy1); const int iy2 = to_cell(fy2);
+
+	return sum_at(ix2, iy2) - sum_at(ix1, iy2) - sum_at(ix2, iy1) + sum_at(ix1, iy1);
+    }
+
+private:
+    static double to_pad(const double v, const bool is_log) { return is_log ? std::log10(v) : v; }
+
+    static int to_cell(const double f) { return std::clamp(static_cast<int>(std::lround(f * n_cell)), 0, n_cell); }
+
+    void build_sum()
+    {
+	sum_.assign((n_cell + 1) * (n_cell + 1), 0);
+	for (int iy = 0; iy < n_cell; ++iy) {
+	    for (int ix = 0; ix < n_cell; ++ix) {
+		sum_[(iy + 1) * (n_cell + 1) + ix + 1] = count_[iy * n_cell + ix]
+		    + sum_[iy * (n_cell + 1) + ix + 1] + sum_[(iy + 1) * (n_cell + 1) + ix] - sum_[iy * (n_cell + 1) + ix];
+	    }
+	}
+    }
+
+    unsigned long sum_at(const int ix, const int iy) const { return sum_[iy * (n_cell + 1) + ix]; }
+
+    bool is_logx_; bool is_logy_;
+    double x_min_; double x_max_;
+    double y_min_; double y_max_;
+    std::vector<unsigned long> count_;
+    std::vector<unsigned long> sum_;
+};
+
+
+/**
+ * Legend corners in NDC inside the frame given by the current margins of the pad.
+ */
+static std::array<double, 4> get_legend_box(TVirtualPad* pad, const FrameRange& range, LegendPosition leg_pos, const double width, const double height)
+{
+    const Double_t top_edge = 1.0 - pad->GetTopMargin() - 0.02;
+    const Double_t right_edge = 1.0 - pad->GetRightMargin() - 0.02;
+    const Double_t bottom_edge = pad->GetBottomMargin() + 0.02;
+    const Double_t left_edge = pad->GetLeftMargin() + 0.02;
 
     switch (leg_pos) {
 	case LegendPosition::TopLeft:
-	    leg = gPad->BuildLegend(left_edge, top_edge, left_edge + width, top_edge - height,  "", option);
-	    break;
+	    return { left_edge, top_edge, left_edge + width, top_edge - height };
 	case LegendPosition::TopRight:
-	    leg = gPad->BuildLegend(right_edge - width, top_edge, right_edge, top_edge - height, "", option);
-	    break;
+	    return { right_edge - width, top_edge, right_edge, top_edge - height };
 	case LegendPosition::BottomRight:
-	    leg = gPad->BuildLegend(right_edge - width, bottom_edge + height, right_edge, bottom_edge, "", option);
-	    break;
+	    return { right_edge - width, bottom_edge + height, right_edge, bottom_edge };
 	case LegendPosition::BottomLeft:
-	    leg = gPad->BuildLegend(width, height, width, height,  "", option);
+	    return { left_edge, bottom_edge + height, left_edge + width, bottom_edge };
+	case LegendPosition::Auto:
 	    break;
 	default:
 	    exit(1);
     }
 
+    OccupancyGrid grid(pad, range);
+    grid.fill(pad->GetListOfPrimitives());
+
+    const double frame_x = pad->GetLeftMargin();
+    const double frame_y = pad->GetBottomMargin();
+    const double frame_w = 1.0 - pad->GetLeftMargin() - pad->GetRightMargin();
+    const double frame_h = 1.0 - pad->GetBottomMargin() - pad->GetTopMargin();
+    const double center_x = 0.5 * (left_edge + right_edge - width);
+
+    /* In order of preference on ties. */
+    const std::array<std::array<double, 4>, 6> candidate_list {{
+	get_legend_box(pad, range, LegendPosition::TopRight, width, height),
+	get_legend_box(pad, range, LegendPosition::TopLeft, width, height),
+	{ center_x, top_edge, center_x + width, top_edge - height },
+	get_legend_box(pad, range, LegendPosition::BottomRight, width, height),
+	get_legend_box(pad, range, LegendPosition::BottomLeft, width, height),
+	{ center_x, bottom_edge + height, center_x + width, bottom_edge }
+    }};
+
+    std::array<double, 4> best_box = candidate_list[0];
+    unsigned long best_count = ~0UL;
+
+    for (const auto& [ x1, y1, x2, y2 ] : candidate_list) {
+	const unsigned long count = grid.count((x1 - frame_x) / frame_w, (std::min(y1, y2) - frame_y) / frame_h,
+		(x2 - frame_x) / frame_w, (std::max(y1, y2) - frame_y) / frame_h);
+	if (count < best_count) {
+	    best_count = count;
+	    best_box = { x1, y1, x2, y2 };
+	}
+    }
+
+    return best_box;
+}
+
+
+/**
+ * Pad coordinates are log10 of the user coordinates on log axes.
+ */
+static FrameRange get_pad_frame_range(TVirtualPad* pad)
+{
+    auto to_user = [](const double v, const bool is_log) { return is_log ? std::pow(10, v) : v; };
+
+    return {
+	to_user(pad->GetUxmin(), pad->GetLogx()), to_user(pad->GetUxmax(), pad->GetLogx()),
+	to_user(pad->GetUymin(), pad->GetLogy()), to_user(pad->GetUymax(), pad->GetLogy())
+    };
+}
+
+
+static TLegend* build_legend(TVirtualPad* pad, const FrameRange& range, LegendPosition leg_pos, Option_t* option, const double width, const double height)
+{
+    const auto [ x1, y1, x2, y2 ] = get_legend_box(pad, range, leg_pos, width, height);
+
+    TLegend* leg = pad->BuildLegend(x1, y1, x2, y2, "", option);
+    own_helper_object(leg);
+
     leg->SetBorderSize(0);
-    leg->SetTextSize(GraphicsSize::current.text_size);
+    leg->SetTextSize(get_current_graphics_size().text_size);
 
     return leg;
 }
 
 
+TLegend* put_legend(LegendPosition leg_pos, Option_t* option, const double width, const double height)
+{
+    gPad->Update();
+
+    return build_legend(gPad, get_pad_frame_range(gPad), leg_pos, option, width, height);
+}
+
+
 TLine* draw_horizontal_line(const double y)
 {
     gPad->Update();
     TLine* l = new TLine(gPad->GetUxmin(), y, gPad->GetUxmax(), y);
+    own_helper_object(l);
     l->Draw("SAME");
     return l;
 }
@@ -161,11 +834,134 @@ TLine* draw_vertical_line(const double x)
 {
     gPad->Update();
     TLine* l = new TLine(x, gPad->GetUymin(), x, gPad->GetUymax());
+    own_helper_object(l);
     l->Draw("SAME");
     return l;
 }
 
 
+FrameRange get_frame_range(TH1* h)
+{
+    if (!h) {
+	fprintf(stderr, "frame histogram is not available for the layout\n");
+	exit(1);
+    }
+
+    const double x_min = h->GetXaxis()->GetXmin();
+    const double x_max = h->GetXaxis()->GetXmax();
+
+    double y_min = h->GetMinimum();
+    double y_max = h->GetMaximum();
+
+    const double margin = gStyle->GetHistTopMargin() * (y_max - y_min);
+    const bool is_min_stored = h->GetMinimumStored() != -1111;
+    const bool is_max_stored = h->GetMaximumStored() != -1111;
+
+    if (!is_max_stored) y_max += margin;
+    if (!is_min_stored) y_min = (y_min >= 0 && y_min - margin < 0) ? 0 : y_min - margin;
+
+    return { x_min, x_max, y_min, y_max };
+}
+
+
+FrameRange get_frame_range(THStack* stack)
+{
+    return get_frame_range(stack->GetHistogram());
+}
+
+
+CanvasLayout::CanvasLayout(TCanvas* c)
+: canvas_(c)
+{
+}
+
+
+void CanvasLayout::put_legend(const int i_pad, LegendPosition leg_pos, Option_t* option, const double width, const double height)
+{
+    const std::string option_copy = option;
+
+    pad_layout_list_[i_pad].decoration_list.emplace_back([=](TVirtualPad* pad, const FrameRange& range)
+    {
+	build_legend(pad, range, leg_pos, option_copy.c_str(), width, height);
+    });
+}
+
+
+void CanvasLayout::draw_horizontal_line(const int i_pad, const double y)
+{
+    pad_layout_list_[i_pad].decoration_list.emplace_back([y](TVirtualPad*, const FrameRange& range)
+    {
+	TLine* l = new TLine(range.x_min, y, range.x_max, y);
+	own_helper_object(l);
+	l->Draw("SAME");
+    });
+}
+
+
+void CanvasLayout::draw_vertical_line(const int i_pad, const double x)
+{
+    pad_layout_list_[i_pad].decoration_list.emplace_back([x](TVirtualPad*, const FrameRange& range)
+    {
+	TLine* l = new TLine(x, range.y_min, x, range.y_max);
+	own_helper_object(l);
+	l->Draw("SAME");
+    });
+}
+
+
+void CanvasLayout::draw_latex_ndc(const int i_pad, const double x0, const double y0, const std::string& content)
+{
+    pad_layout_list_[i_pad].decoration_list.emplace_back([=](TVirtualPad*, const FrameRange&)
+    {
+	ROOT_helper::draw_latex_ndc(x0, y0, content);
+    });
+}
+
+
+/**
+ * Pads without queued axes use their current user range for lines.
+ */
+void CanvasLayout::apply()
+{
+    ROOT_HELPER_TRACE_SPAN("CanvasLayout::apply");
+
+    TVirtualPad* pad_saved = gPad;
+
+    for (auto& [ i_pad, pad_layout ] : pad_layout_list_) {
+	TVirtualPad* pad = canvas_->GetPad(i_pad);
+
+	if (!pad) {
+	    fprintf(stderr, "pad %d was not found in %s\n", i_pad, canvas_->GetName());
+	    exit(1);
+	}
+
+	pad->cd();
+
+	FrameRange range;
+	if (pad_layout.set_axes) {
+	    range = pad_layout.set_axes();
+	} else {
+	    range = get_pad_frame_range(pad);
+	}
+
+	for (auto& decoration : pad_layout.decoration_list) {
+	    decoration(pad, range);
+	}
+
+	pad->Modified();
+    }
+
+    pad_layout_list_.clear();
+
+    {
+	ROOT_HELPER_TRACE_SPAN("TCanvas::Update");
+	canvas_->Update();
+    }
+
+    if (pad_saved) pad_saved->cd();
+}
+
+
 namespace publish
 {
 
@@ -280,34 +1076,11 @@ TMultiGraph* set_multigraph_axis_from_member(TMultiGraph* mg)
 }
 
 
-double find_x(const TGraph*g, const double y, double x_start, double x_end)
-{
-    if (x_start >= x_end) {
-	x_start = *std::min_element(g->GetX(), g->GetX() + g->GetN());
-	x_end = *std::max_element(g->GetX(), g->GetX() + g->GetN());
-    }
-    TSpline* spl = new TSpline3("spl_g", g);
-    TF1* f = new TF1("f_spl_g", [spl](const double* x, const double* p) { return spl->Eval(x[0]); }, x_start, x_end, 0);
-
-    double x = 0;
-    if (y > f->GetMaximum(x_start, x_end)) {
-	x = f->GetMaximumX(x_start, x_end);
-    } else if (y < f->GetMinimum(x_start, x_end)) {
-	x = f->GetMinimumX(x_start, x_end);
-    } else {
-	x = f->GetX(y, x_start, x_end);
-    }
-
-    delete f;
-    delete spl;
-
-    return x;
-}
-
-
 TLatex* draw_latex_ndc(const double x0, const double y0, const std::string& content)
 {
-    return kLatex.DrawLatexNDC(x0, y0, content.c_str());
+    TLatex* latex = get_latex_template().DrawLatexNDC(x0, y0, content.c_str());
+    own_helper_object(latex);
+    return latex;
 }
 
 
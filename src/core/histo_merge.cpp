@@ -0,0 +1,177 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/histo_merge.h>
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/parallel.h>
+#include <ROOT_helper/trace.h>
+#endif
+
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TAxis.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TH1.h>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace ROOT_helper
+{
+
+
+static bool is_same_axis(const TAxis* a0, const TAxis* a1)
+{
+    const int n_bin = a0->GetNbins();
+    if (n_bin != a1->GetNbins()) return false;
+
+    const double tolerance = 1e-10 * std::abs(a0->GetXmax() - a0->GetXmin());
+    for (int bin = 1; bin <= n_bin + 1; ++bin) {
+	if (std::abs(a0->GetBinLowEdge(bin) - a1->GetBinLowEdge(bin)) > tolerance) return false;
+    }
+
+    return true;
+}
+
+
+bool is_same_binning(const TH1* h0, const TH1* h1)
+{
+    return h0->GetDimension() == h1->GetDimension()
+	&& is_same_axis(h0->GetXaxis(), h1->GetXaxis())
+	&& is_same_axis(h0->GetYaxis(), h1->GetYaxis())
+	&& is_same_axis(h0->GetZaxis(), h1->GetZaxis());
+}
+
+
+/**
+ * Histograms are owned by the file and deleted with it unless detached.
+ */
+static std::vector<TH1*> read_histos(TFile* f, const std::filesystem::path& file_name, const std::vector<std::string>& path_list)
+{
+    std::vector<TH1*> h_list;
+
+    for (const auto& path : path_list) {
+	TH1* h = nullptr;
+	f->GetObject(path.c_str(), h);
+
+	if (!h) {
+	    fprintf(stderr, "%s was not found in %s\n", path.c_str(), file_name.c_str());
+	    exit(1);
+	}
+
+	h_list.emplace_back(h);
+    }
+
+    return h_list;
+}
+
+
+static std::unique_ptr<TFile> open_file(const std::filesystem::path& file_name)
+{
+    std::unique_ptr<TFile> f(TFile::Open(file_name.c_str(), "READ"));
+
+    if (!f || f->IsZombie()) {
+	fprintf(stderr, "%s could not be opened\n", file_name.c_str());
+	exit(1);
+    }
+
+    return f;
+}
+
+
+std::vector<TH1*> merge_histos(const std::vector<std::filesystem::path>& file_name_list, const std::vector<std::string>& path_list, unsigned int n_thread)
+{
+    ROOT_HELPER_TRACE_SPAN("merge_histos");
+
+    const size_t n_file = file_name_list.size();
+    const size_t n_histo = path_list.size();
+
+    if (n_file == 0) {
+	fprintf(stderr, "no file given to merge %zu histograms\n", n_histo);
+	exit(1);
+    }
+
+    TDirectory::TContext context;
+
+    std::vector<std::unique_ptr<TH1>> reference_list;
+    {
+	auto f = open_file(file_name_list[0]);
+	for (auto* h : read_histos(f.get(), file_name_list[0], path_list)) {
+	    h->SetDirectory(nullptr);
+	    reference_list.emplace_back(h);
+	}
+    }
+
+    if (n_thread == 0) n_thread = get_default_n_thread();
+    n_thread = std::max<size_t>(1, std::min<size_t>(n_thread, n_file));
+
+    if (n_thread > 1) enable_thread_safety();
+
+    // Every file is checked before the first Add, so that a mismatch stops the merge before any work is done on the sums.
+    parallel_for(n_thread, [&](const size_t i_thread)
+    {
+	for (size_t i_file = i_thread + 1; i_file < n_file; i_file += n_thread) {
+	    auto f = open_file(file_name_list[i_file]);
+	    const std::vector<TH1*> h_list = read_histos(f.get(), file_name_list[i_file], path_list);
+
+	    for (size_t i_histo = 0; i_histo < n_histo; ++i_histo) {
+		if (!is_same_binning(reference_list[i_histo].get(), h_list[i_histo])) {
+		    fprintf(stderr, "%s in %s has binning different from %s\n",
+			    path_list[i_histo].c_str(), file_name_list[i_file].c_str(), file_name_list[0].c_str());
+		    exit(1);
+		}
+	    }
+	}
+    }, n_thread);
+
+    // partial_list[i_thread][i_histo]
+    std::vector<std::vector<TH1*>> partial_list(n_thread);
+
+    parallel_for(n_thread, [&](const size_t i_thread)
+    {
+	std::vector<TH1*>& partial = partial_list[i_thread];
+
+	for (size_t i_file = i_thread; i_file < n_file; i_file += n_thread) {
+	    auto f = open_file(file_name_list[i_file]);
+	    const std::vector<TH1*> h_list = read_histos(f.get(), file_name_list[i_file], path_list);
+
+	    if (partial.empty()) {
+		for (auto* h : h_list) h->SetDirectory(nullptr);
+		partial = h_list;
+	    } else {
+		for (size_t i_histo = 0; i_histo < n_histo; ++i_histo) partial[i_histo]->Add(h_list[i_histo]);
+	    }
+	}
+    }, n_thread);
+
+    for (size_t stride = 1; stride < n_thread; stride *= 2) {
+	parallel_for((n_thread + 2 * stride - 1) / (2 * stride), [&](const size_t i_pair)
+	{
+	    const size_t i_thread = 2 * stride * i_pair;
+	    if (i_thread + stride >= n_thread) return;
+
+	    for (size_t i_histo = 0; i_histo < n_histo; ++i_histo) {
+		partial_list[i_thread][i_histo]->Add(partial_list[i_thread + stride][i_histo]);
+		delete partial_list[i_thread + stride][i_histo];
+	    }
+	}, n_thread);
+    }
+
+    for (auto* h : partial_list[0]) register_in_current_scope(h);
+
+    return partial_list[0];
+}
+
+
+TH1* merge_histo(const std::vector<std::filesystem::path>& file_name_list, const std::string& path, unsigned int n_thread)
+{
+    return merge_histos(file_name_list, { path }, n_thread)[0];
+}
+
+
+} // namespace ROOT_helper
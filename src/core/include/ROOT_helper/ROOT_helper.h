@@ -6,6 +6,17 @@
 #include <ROOT_helper/graphics.h>
 #include <ROOT_helper/container.h>
 #include <ROOT_helper/analysis.h>
+#include <ROOT_helper/parallel.h>
+#include <ROOT_helper/transform.h>
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/page_renderer.h>
+#include <ROOT_helper/time_series.h>
+#include <ROOT_helper/trace.h>
+#include <ROOT_helper/text_loader.h>
+#include <ROOT_helper/batch_fit.h>
+#include <ROOT_helper/stage_cache.h>
+#include <ROOT_helper/histo_merge.h>
+#include <ROOT_helper/file_pool.h>
 
 
 #endif
@@ -1,15 +1,156 @@
-#ifndef ROOT_HELPER_CONTAINER_H
-#define ROOT_HELPER_CONTAINER_H
+#ifndef ROOT_HELPER_ANALYSIS_H
+#define ROOT_HELPER_ANALYSIS_H
 
 
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <TAxis.h>
+#include <TGraph.h>
+#include <TGraphAsymmErrors.h>
 #include <TGraphErrors.h>
+#include <TH1.h>
+#include <TH2.h>
+#include <TVirtualFFT.h>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/container.h>
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/parallel.h>
+#endif
 
 
 namespace ROOT_helper
 {
 
 
+/**
+ * Non-owning view of a contiguous array.
+ */
+template<class T>
+class Span
+{
+public:
+    Span() = default;
+    Span(T* data, const size_t size) : data_(data), size_(size) { }
+
+    template<class U, class = std::enable_if_t<std::is_same_v<std::remove_const_t<T>, U>>>
+    Span(std::vector<U>& v) : data_(v.data()), size_(v.size()) { }
+
+    template<class U, class = std::enable_if_t<std::is_const_v<T> && std::is_same_v<std::remove_const_t<T>, U>>>
+    Span(const std::vector<U>& v) : data_(v.data()), size_(v.size()) { }
+
+    template<class U, class = std::enable_if_t<std::is_const_v<T> && std::is_same_v<std::remove_const_t<T>, U>>>
+    Span(const Span<U>& s) : data_(s.data()), size_(s.size()) { }
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](const size_t i) const { return data_[i]; }
+
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+
+    Span subspan(const size_t offset, const size_t count) const { return Span(data_ + offset, count); }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+
+/**
+ * Point arrays of a graph. Empty error spans mean no errors.
+ */
+template<class T>
+struct BasicGraphView
+{
+    Span<T> x; Span<T> y;
+    Span<T> ex; Span<T> ey;
+
+    size_t size() const { return x.size(); }
+};
+
+
+using GraphView = BasicGraphView<const double>;
+using MutableGraphView = BasicGraphView<double>;
+
+
+GraphView make_graph_view(const TGraph* g);
+
+
+MutableGraphView make_mutable_graph_view(TGraph* g);
+
+
+/**
+ * Array-based kernels.
+ * Bin arrays exclude the underflow and overflow bins; edges have one entry more than the bins.
+ * Errors of histograms are given as sum of squared weights (TH1::GetSumw2()).
+ */
+void scale_bin_edges(Span<double> edges, const double scale);
+
+
+void convert_to_density(Span<const double> edges, Span<double> content, Span<double> sumw2);
+
+
+void convert_to_density(const double bin_width, Span<double> content, Span<double> sumw2);
+
+
+void get_g0xa_plus_g1(const double a, const GraphView& g0, const GraphView& g1, const MutableGraphView& g_sum);
+
+
+double find_x(Span<const double> x, Span<const double> y, const double y_target, double x_start=0, double x_end=0);
+
+
+/**
+ * Smoothing kernels for uniformly sampled arrays.
+ * With is_variance, the input is a variance array propagated through the squared filter weights.
+ * Moving average truncates the window at the edges.
+ */
+void moving_average(Span<const double> in, Span<double> out, const size_t half_window, const bool is_variance=false);
+
+
+/**
+ * Least-squares polynomial smoothing with coefficients precomputed for every position in the window.
+ * Edge points are evaluated from the polynomial fitted to the first or last full window.
+ */
+class SavitzkyGolayFilter
+{
+public:
+    SavitzkyGolayFilter(const size_t half_window, const int polynomial_order);
+
+    void apply(Span<const double> in, Span<double> out, const bool is_variance=false) const;
+
+    size_t get_half_window() const { return half_window_; }
+    int get_polynomial_order() const { return polynomial_order_; }
+
+private:
+    size_t half_window_;
+    int polynomial_order_;
+    std::vector<double> coefficient_;
+    std::vector<double> squared_coefficient_;
+};
+
+
+/**
+ * y_i = alpha x_i + (1 - alpha) y_{i-1}. zero_phase runs a second, backward pass to cancel the lag.
+ * With is_variance, in and out are variances of uncorrelated inputs; for zero_phase they are propagated through the
+ * combined two-pass kernel, since the backward pass acts on correlated values.
+ */
+void exponential_smoothing(Span<const double> in, Span<double> out, const double alpha, const bool zero_phase=false, const bool is_variance=false);
+
+
+/**
+ * Adapters for ROOT objects.
+ */
 TH1* scale_histo_x(TH1* h, const double scale);
 
 
@@ -19,6 +160,177 @@ TH1* convert_to_density_histo(TH1* h);
 TGraphErrors* get_graph_g0xa_plus_g1(const double a, const TGraphErrors* g0, const TGraphErrors* g1);
 
 
+/**
+ * Equivalent to calling Fill for every entry; empty w means unit weights.
+ * Each thread counts into private bin arrays that are then added to h, together with Sumw2, the entries and the statistics.
+ * Uniform axes compute bin indices arithmetically in blocks; variable axes use a binary search on the edges.
+ * Histograms with a fill buffer, extendable or labelled axes, or overflows counted in the statistics are filled entry by entry.
+ * Profiles are not histograms of this kind; passing one, or a histogram of another dimension, is fatal.
+ */
+TH1* bulk_fill_histo(TH1* h, Span<const double> x, Span<const double> w={}, unsigned int n_thread=0);
+
+
+TH2* bulk_fill_histo(TH2* h, Span<const double> x, Span<const double> y, Span<const double> w={}, unsigned int n_thread=0);
+
+
+/**
+ * Smooth y in place. Errors of TGraphErrors are propagated assuming uncorrelated points.
+ */
+TGraph* smooth_graph_moving_average(TGraph* g, const size_t half_window);
+
+
+TGraph* smooth_graph_savitzky_golay(TGraph* g, const SavitzkyGolayFilter& filter);
+
+
+TGraph* smooth_graph_savitzky_golay(TGraph* g, const size_t half_window, const int polynomial_order=2);
+
+
+TGraph* smooth_graph_exponential(TGraph* g, const double alpha, const bool zero_phase=false);
+
+
+/**
+ *   smooth_graphs(graph_list, [&filter](TGraph* g) { smooth_graph_savitzky_golay(g, filter); });
+ */
+template<class SmoothingType>
+void smooth_graphs(const std::vector<TGraph*>& graph_list, SmoothingType smoothing, unsigned int n_thread=0)
+{
+    parallel_for(graph_list.size(), [&](const size_t i) { smoothing(graph_list[i]); }, n_thread);
+}
+
+
+enum class WindowFunction
+{
+    Rectangular, Hann, Hamming, Blackman
+};
+
+
+std::vector<double> get_window_coefficients(const WindowFunction window, const size_t n);
+
+
+/**
+ * One-sided spectra of uniformly sampled graphs through TVirtualFFT (FFTW plug-in).
+ * FFT plans and window coefficients are created once per input length and reused.
+ * An analyzer must not be shared between threads.
+ */
+class SpectrumAnalyzer
+{
+public:
+    SpectrumAnalyzer(const WindowFunction window=WindowFunction::Hann);
+    ~SpectrumAnalyzer();
+
+    /**
+     * Power spectral density in (y unit)^2 / (1 / x unit).
+     */
+    TGraph* get_power_spectrum(const TGraph* g);
+
+    /**
+     * Amplitude of each sinusoidal component and its phase in rad.
+     */
+    std::pair<TGraph*, TGraph*> get_amplitude_phase(const TGraph* g);
+
+private:
+    struct Plan
+    {
+	std::unique_ptr<TVirtualFFT> fft;
+	std::vector<double> window;
+	std::vector<double> buffer;
+	double window_sum;
+	double window_square_sum;
+    };
+
+    Plan& transform(const TGraph* g, double& frequency_step);
+
+    WindowFunction window_;
+    std::map<int, Plan> plan_list_;
+};
+
+
+/**
+ * Graphs are split across n_thread workers, each with its own analyzer; more than one worker calls enable_thread_safety().
+ * The ObjectList overloads stop on a member that is not a TGraph.
+ */
+std::vector<TGraph*> get_power_spectrum_graphs(const std::vector<TGraph*>& graph_list, const WindowFunction window=WindowFunction::Hann, unsigned int n_thread=0);
+
+
+std::vector<std::pair<TGraph*, TGraph*>> get_amplitude_phase_graphs(const std::vector<TGraph*>& graph_list, const WindowFunction window=WindowFunction::Hann, unsigned int n_thread=0);
+
+
+inline std::vector<TGraph*> get_power_spectrum_graphs(const ObjectList& object_list, const WindowFunction window=WindowFunction::Hann, unsigned int n_thread=0)
+{
+    return get_power_spectrum_graphs(object_list.get_checked_object_list<TGraph>(), window, n_thread);
+}
+
+
+inline std::vector<std::pair<TGraph*, TGraph*>> get_amplitude_phase_graphs(const ObjectList& object_list, const WindowFunction window=WindowFunction::Hann, unsigned int n_thread=0)
+{
+    return get_amplitude_phase_graphs(object_list.get_checked_object_list<TGraph>(), window, n_thread);
+}
+
+
+enum class EnvelopeBand
+{
+    MeanRMS, MeanStandardError, MinMax
+};
+
+
+/**
+ * Per-point running statistics of graphs sharing one x grid (Welford mean/variance, min/max).
+ * Memory is proportional to the number of points only.
+ * x values agree within 1e-9 of the x span of the grid; a member of an ObjectList or MultiObject that is not a TGraph is fatal.
+ *
+ *   EnvelopeBuilder envelope;
+ *   envelope.add(object_list);
+ *   multi_object.Add(envelope.get_band_graph(EnvelopeBand::MinMax), "3");
+ */
+class EnvelopeBuilder
+{
+public:
+    void add(const TGraph* g);
+    void add(const std::vector<TGraph*>& graph_list);
+    void add(const ObjectList& object_list);
+    void add(const MultiObject& multi_object);
+
+    size_t get_n_graph() const { return n_graph_; }
+
+    /**
+     * Band around the mean with asymmetric y errors.
+     */
+    TGraphAsymmErrors* get_band_graph(const EnvelopeBand band=EnvelopeBand::MeanRMS) const;
+
+private:
+    std::vector<double> x_;
+    std::vector<double> mean_;
+    std::vector<double> m2_;
+    std::vector<double> min_;
+    std::vector<double> max_;
+    double x_tolerance_ = 0;
+    size_t n_graph_ = 0;
+    std::string x_title_;
+    std::string y_title_;
+};
+
+
+inline void EnvelopeBuilder::add(const ObjectList& object_list)
+{
+    add(object_list.get_checked_object_list<TGraph>());
+}
+
+
+inline void EnvelopeBuilder::add(const MultiObject& multi_object)
+{
+    for (auto* obj : multi_object.get_object_list<TObject>()) {
+	const auto* g = dynamic_cast<const TGraph*>(obj);
+
+	if (!g) {
+	    fprintf(stderr, "%s in the envelope input is a %s\n", obj->GetName(), obj->ClassName());
+	    exit(1);
+	}
+
+	add(g);
+    }
+}
+
+
 } // namespace ROOT_helper
 
 
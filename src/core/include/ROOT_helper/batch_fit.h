@@ -0,0 +1,99 @@
+#ifndef ROOT_HELPER_BATCH_FIT_H
+#define ROOT_HELPER_BATCH_FIT_H
+
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <TF1.h>
+#include <TGraphErrors.h>
+#include <TObject.h>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/analysis.h>
+#include <ROOT_helper/container.h>
+#endif
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * Fit results in columns, one entry per object in input order.
+ * value_list[i_parameter][i_object]; status_list holds the fit status, 0 for a converged fit.
+ * Objects that could not be fitted at all (no points in range, or the minimizer gave up) have status -1 and NaN values;
+ * other non-zero statuses keep the values and errors the minimizer ended with.
+ */
+struct FitResultTable
+{
+    std::vector<std::string> parameter_name_list;
+    std::vector<std::string> object_name_list;
+    std::vector<std::vector<double>> value_list;
+    std::vector<std::vector<double>> error_list;
+    std::vector<double> chi2_list;
+    std::vector<int> ndf_list;
+    std::vector<int> status_list;
+
+    size_t size() const { return object_name_list.size(); }
+
+    size_t get_parameter_index(const std::string& parameter_name) const;
+
+    /**
+     * Parameter against x (the object index if x is empty) with its error as y error, skipping fits with a non-zero status.
+     */
+    TGraphErrors* get_parameter_graph(const size_t i_parameter, Span<const double> x={}) const;
+    TGraphErrors* get_parameter_graph(const std::string& parameter_name, Span<const double> x={}) const;
+
+    TGraph* get_chi2_ndf_graph(Span<const double> x={}) const;
+};
+
+
+struct BatchFitOption
+{
+    /**
+     * Equal x_min and x_max fit the full range of each object.
+     */
+    double x_min = 0;
+    double x_max = 0;
+
+    /**
+     * Poisson likelihood instead of chi2 for histograms.
+     */
+    bool is_likelihood = false;
+
+    /**
+     * Starts each fit from the result of the preceding object handled by the same thread.
+     * Objects are split into n_thread contiguous blocks, so the chain restarts from the model at each block.
+     */
+    bool is_seeded_from_previous = false;
+
+    /**
+     * Called before each fit to set initial parameters from the data, e.g. from the mean and RMS of a histogram.
+     * It is called concurrently from the worker threads, each with its own clone of the model,
+     * so anything it shares beyond obj and f needs its own locking.
+     */
+    std::function<void(const TObject* obj, TF1* f)> initialize;
+
+    unsigned int n_thread = 0;
+};
+
+
+/**
+ * Fits TH1 (including TH2 with a TF2) and TGraph objects with clones of model, one clone per thread.
+ * Parameter limits and fixed parameters of model are kept. Minuit2 is used since it is thread-safe.
+ * With more than one thread, enable_thread_safety() is called.
+ * The objects themselves are not modified.
+ */
+FitResultTable fit_objects(const std::vector<TObject*>& object_list, const TF1* model, const BatchFitOption& option={});
+
+
+FitResultTable fit_objects(const ObjectList& object_list, const TF1* model, const BatchFitOption& option={});
+
+
+} // namespace ROOT_helper
+
+
+#endif
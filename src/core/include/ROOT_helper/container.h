@@ -10,9 +10,13 @@
 #include <TGraph.h>
 #include <THStack.h>
 #include <TMultiGraph.h>
+#include <cstdio>
+#include <cstdlib>
 
 #ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/file_pool.h>
 #include <ROOT_helper/graphics.h>
+#include <ROOT_helper/trace.h>
 #endif
 
 
@@ -32,12 +36,30 @@ public:
     template<class ObjectType>
     int load_data(TDirectory* directory, const std::vector<std::string>& path_list, const std::vector<std::string>& title_list = {});
 
+    /**
+     * Loads "file:path" specs, e.g. "run_001.root:dir/h_energy", through pool so that files are opened once and
+     * the number of open files stays bounded. The objects are owned by the list's caller, not by the files.
+     */
+    template<class ObjectType>
+    int load_data(const std::vector<std::string>& spec_list, const std::vector<std::string>& title_list = {}, FilePool& pool = FilePool::get_global());
+
+    /**
+     * Adds an object created in memory; its path is its name. An empty title keeps the title of obj; a title for an obj that is not a TNamed is fatal.
+     */
+    void add_object(TObject* obj, const std::string& title="");
+
     int get_list_size() const { return object_list_.size(); }
     const std::vector<TObject*>& get_object_list() const { return object_list_; }
 
     template<class ObjectType>
     std::vector<ObjectType*> get_converted_object_list() const;
 
+    /**
+     * Like get_converted_object_list, but an object that is not an ObjectType is fatal.
+     */
+    template<class ObjectType>
+    std::vector<ObjectType*> get_checked_object_list() const;
+
     template<class ObjectType>
     ObjectType* get_object(const int i) const { return dynamic_cast<ObjectType*>(object_list_.at(i)); }
 
@@ -46,6 +68,11 @@ public:
     std::string list_name_;
 
 private:
+    /**
+     * Shared by load_data and add_object. An empty title keeps the title of obj.
+     */
+    void push_object(TObject* obj, TDirectory* directory, const std::string& path, const std::string& title);
+
     std::vector<TObject*> object_list_;
     std::vector<TDirectory*> directory_list_;
     std::vector<std::string> path_list_;
@@ -56,6 +83,8 @@ private:
 template<class ObjectType>
 int ObjectList::load_data(TDirectory* directory, const std::vector<std::string>& _path_list, const std::vector<std::string>& _title_list)
 {
+    ROOT_HELPER_TRACE_SPAN("ObjectList::load_data");
+
     const int n_obj = _path_list.size();
 
     for (int i_obj = 0; i_obj < n_obj; ++i_obj) {
@@ -67,18 +96,24 @@ int ObjectList::load_data(TDirectory* directory, const std::vector<std::string>&
 	    exit(1);
 	}
 
-	object_list_.emplace_back(obj_buffer);
+	push_object(obj_buffer, directory, _path_list[i_obj], i_obj < _title_list.size() ? _title_list[i_obj] : "");
+    }
 
-	directory_list_.emplace_back(directory);
+    return n_obj;
+}
 
-	path_list_.emplace_back(_path_list[i_obj]);
 
-	if (i_obj < _title_list.size()) {
-	    static_cast<TNamed*>(obj_buffer)->SetTitle(_title_list[i_obj].c_str());
-	    title_list_.emplace_back(_title_list[i_obj]);
-	} else {
-	    title_list_.emplace_back(object_list_.back()->GetTitle());
-	}
+template<class ObjectType>
+int ObjectList::load_data(const std::vector<std::string>& _spec_list, const std::vector<std::string>& _title_list, FilePool& pool)
+{
+    ROOT_HELPER_TRACE_SPAN("ObjectList::load_data");
+
+    const int n_obj = _spec_list.size();
+
+    for (int i_obj = 0; i_obj < n_obj; ++i_obj) {
+	ObjectType* obj_buffer = pool.read_object<ObjectType>(_spec_list[i_obj]);
+
+	push_object(obj_buffer, nullptr, _spec_list[i_obj], i_obj < _title_list.size() ? _title_list[i_obj] : "");
     }
 
     return n_obj;
@@ -98,6 +133,26 @@ std::vector<ObjectType*> ObjectList::get_converted_object_list() const
 }
 
 
+template<class ObjectType>
+std::vector<ObjectType*> ObjectList::get_checked_object_list() const
+{
+    std::vector<ObjectType*> converted_object_list;
+
+    for (auto* obj : object_list_) {
+	ObjectType* converted_obj = dynamic_cast<ObjectType*>(obj);
+
+	if (!converted_obj) {
+	    fprintf(stderr, "%s in %s is a %s\n", obj->GetName(), list_name_.c_str(), obj->ClassName());
+	    exit(1);
+	}
+
+	converted_object_list.emplace_back(converted_obj);
+    }
+
+    return converted_object_list;
+}
+
+
 struct IContainerWrapper
 {
     virtual ~IContainerWrapper() = default;
@@ -109,6 +164,8 @@ struct IContainerWrapper
     virtual double GetMinimum() = 0;
     virtual double GetMaximum() = 0;
 
+    virtual FrameRange get_frame_range() = 0;
+
     virtual std::vector<TObject*> get_object_list() const = 0;
 };
 
@@ -183,6 +240,8 @@ public:
     double GetMinimum() override;
     double GetMaximum() override;
 
+    FrameRange get_frame_range() override;
+
     std::vector<TObject*> get_object_list() const override;
 
     ContainerType* container_;
@@ -257,6 +316,13 @@ double ContainerWrapper<ContainerType>::GetMaximum()
 }
 
 
+template<class ContainerType>
+FrameRange ContainerWrapper<ContainerType>::get_frame_range()
+{
+    return ROOT_helper::get_frame_range(container_);
+}
+
+
 template<class ContainerType>
 std::vector<TObject*> ContainerWrapper<ContainerType>::get_object_list() const
 {
@@ -287,8 +353,15 @@ public:
     MultiObject(MultiObjectType object_type, const std::string& nametitle, const std::vector<TObject*> obj_list, const std::string& add_option="");
     ~MultiObject();
 
+    void Add(TObject* obj, const std::string& add_option="");
+
     void Draw(std::string option="");
 
+    /**
+     * Draws into pad i_pad of the layout's canvas and leaves the axes to the layout.
+     */
+    void Draw(CanvasLayout& layout, const int i_pad, std::string option="");
+
     template<class ContainerType>
     ContainerType* get_container() const;
 
@@ -2,7 +2,12 @@
 #define ROOT_HELPER_DATASAVER_H
 
 
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 #include <TCanvas.h>
 #include <TFile.h>
@@ -12,15 +17,75 @@
 #include <TGraph.h>
 #include <TGraph2D.h>
 
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/trace.h>
+#endif
+
 
 namespace ROOT_helper
 {
 
 
+/**
+ * Location of an object saved by DataSaver. Paths are relative to the base directory.
+ * Entries of canvases written without data saving have only image paths and seek_key = -1.
+ */
+struct DataIndexEntry
+{
+    std::string path;
+    std::string class_name;
+    int64_t seek_key = -1;
+    int32_t n_byte = 0;
+    int32_t key_length = 0;
+    int32_t object_length = 0;
+    std::string pdf_path;
+    std::string png_path;
+    std::string columnar_path;
+};
+
+
+/**
+ * Sidecar index "<data file>.index" written by DataSaver, readable without ROOT:
+ *   "RHIDX001", then one record per write:
+ *   uint32 record length (excluding itself), int64 seek_key, int32 n_byte, int32 key_length, int32 object_length,
+ *   and path, class_name, pdf_path, png_path, columnar_path, each as uint16 length and bytes (native byte order).
+ * The object data starts at seek_key + key_length and occupies n_byte - key_length bytes, compressed if object_length is larger.
+ * Records are appended; a later record of the same path replaces the data location or the file paths it sets.
+ * A truncated last record, as left by a crash, is ignored.
+ * Older records without the trailing columnar_path are read with it empty.
+ */
+class DataIndex
+{
+public:
+    DataIndex(const std::filesystem::path& index_file_name);
+
+    static std::filesystem::path get_index_file_name(const std::filesystem::path& data_file_name);
+
+    /**
+     * nullptr if path was never saved.
+     */
+    const DataIndexEntry* find(const std::string& path) const;
+
+    /**
+     * Reads the object at its recorded offset without walking the directories of f.
+     * The caller owns the returned object; histograms are not attached to f.
+     */
+    TObject* read_object(TFile* f, const std::string& path) const;
+
+    size_t size() const { return entry_map_.size(); }
+
+private:
+    std::unordered_map<std::string, DataIndexEntry> entry_map_;
+};
+
+
 class DataSaver
 {
 public:
-    DataSaver(const std::filesystem::path& base_directory, const bool is_recreate=false);
+    /**
+     * Processes writing to the same base directory need different data_file_name.
+     */
+    DataSaver(const std::filesystem::path& base_directory, const bool is_recreate=false, const std::string& data_file_name="data.root");
     ~DataSaver();
 
     template<class ObjectType>
@@ -30,13 +95,49 @@ public:
 
     void write_canvas_without_data_saving(TCanvas* c, const std::filesystem::path& relative_save_directory="") const;
 
+    /**
+     * Updates c and prints <write_directory>/<name>.pdf and <write_directory>/png/<name>.png, with no data file or index.
+     */
+    static void print_canvas(TCanvas* c, const std::filesystem::path& write_directory);
+
     std::filesystem::path create_directories(const std::filesystem::path& relative_path) const;
 
+    /**
+     * Additionally writes every saved TGraph, 1D and 2D TH1 to <relative directory>/columnar/<name>.rhcol,
+     * for consumers without ROOT. Layout (native byte order):
+     *   "RHCOL001", uint32 header_length, uint32 n_column,
+     *   n_column descriptors of char name[16], uint32 dtype (1: float64), uint32 0, uint64 length, uint64 offset,
+     *   name, title, x_title, y_title, z_title, each as uint16 length and bytes, zero padding to header_length.
+     * Columns start at their offset from the beginning of the file, aligned to 8 bytes, so they can be memory-mapped as arrays:
+     *   TGraph: x, y, and ex, ey or exl, exh, eyl, eyh for graphs with errors.
+     *   TH1: x_edges, content, error over the bins without underflow and overflow;
+     *   TH2 adds y_edges, with content and error of length n_x * n_y and x running fastest.
+     */
+    void set_columnar_export(const bool is_columnar_export) { is_columnar_export_ = is_columnar_export; }
+
+    /**
+     * Printing (gVirtualPS) and ROOT file writes are not thread-safe; all DataSaver output holds this lock.
+     */
+    static std::recursive_mutex& get_output_mutex();
+
 private:
     void create_and_change_directory(const std::filesystem::path& relative_save_directory) const;
 
+    /**
+     * Writes obj to the current directory and appends its key location to the index.
+     */
+    void write_object(TObject* obj, const std::filesystem::path& relative_save_directory) const;
+    void append_index_entry(const DataIndexEntry& entry) const;
+
+    /**
+     * Relative path of the written file, empty if obj has no columnar form.
+     */
+    std::string write_columnar(const TObject* obj, const std::filesystem::path& relative_save_directory) const;
+
     const std::filesystem::path base_directory_;
     std::unique_ptr<TFile> f_write_;
+    mutable std::ofstream index_stream_;
+    bool is_columnar_export_ = false;
     std::vector<TClass*> class_to_save_list_ = std::vector<TClass*> {
 	TClass::GetClass<TH1>(), TClass::GetClass<TGraph>(), TClass::GetClass<TGraph2D>(), TClass::GetClass<TMultiGraph>()
     };
@@ -46,6 +147,10 @@ private:
 template<class ObjectType>
 void DataSaver::save_object(ObjectType* obj, const std::filesystem::path& relative_save_directory) const
 {
+    ROOT_HELPER_TRACE_SPAN("DataSaver::save_object");
+
+    std::lock_guard<std::recursive_mutex> lock(get_output_mutex());
+
     create_and_change_directory(relative_save_directory);
 
     auto save_child = [relative_save_directory, this](TList* list)
@@ -58,18 +163,18 @@ void DataSaver::save_object(ObjectType* obj, const std::filesystem::path& relati
     };
 
     if (obj->InheritsFrom(TClass::GetClass<TPad>())) {
-	if (obj->InheritsFrom(TClass::GetClass<TCanvas>())) obj->Write("", TObject::kOverwrite);
+	if (obj->InheritsFrom(TClass::GetClass<TCanvas>())) write_object(obj, relative_save_directory);
 	save_child(dynamic_cast<TPad*>(obj)->GetListOfPrimitives());
     } else if (obj->InheritsFrom(TClass::GetClass<TMultiGraph>())) {
-	obj->Write("", TObject::kOverwrite);
+	write_object(obj, relative_save_directory);
 	save_child(dynamic_cast<TMultiGraph*>(obj)->GetListOfGraphs());
     } else if (obj->InheritsFrom(TClass::GetClass<THStack>())) {
-	obj->Write("", TObject::kOverwrite);
+	write_object(obj, relative_save_directory);
 	save_child(dynamic_cast<THStack*>(obj)->GetHists());
     } else {
 	for (const auto* class_type : class_to_save_list_) {
 	    if (obj->InheritsFrom(class_type)) {
-		obj->Write("", TObject::kOverwrite);
+		write_object(obj, relative_save_directory);
 		break;
 	    }
 	}
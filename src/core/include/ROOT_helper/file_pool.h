@@ -0,0 +1,111 @@
+#ifndef ROOT_HELPER_FILE_POOL_H
+#define ROOT_HELPER_FILE_POOL_H
+
+
+#include <cstddef>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <TFile.h>
+#include <TObject.h>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * "run_001.root:dir/h_energy" -> { "run_001.root", "dir/h_energy" }, split at the last ':' so that URLs keep their scheme.
+ */
+std::pair<std::string, std::string> split_object_spec(const std::string& spec);
+
+
+struct FilePoolStats
+{
+    size_t n_open = 0;
+    size_t n_reuse = 0;
+    size_t n_close = 0;
+};
+
+
+/**
+ * Read-only TFiles shared between loads, with at most max_n_open files open at once.
+ * When the limit is reached, the least recently used file is closed.
+ * A pooled file keeps its key lists in memory, so further objects from it are found without re-reading headers.
+ * Histograms read through the pool are detached from their file, so closing the file does not delete them.
+ */
+class FilePool
+{
+public:
+    FilePool(const size_t max_n_open=64);
+    ~FilePool();
+
+    /**
+     * The returned file stays open at least until max_n_open other files have been requested.
+     */
+    TFile* get_file(const std::filesystem::path& file_name);
+
+    /**
+     * A missing file or object is fatal. The caller owns the returned object.
+     */
+    TObject* read_object(const std::string& spec);
+
+    template<class ObjectType>
+    ObjectType* read_object(const std::string& spec);
+
+    void set_max_n_open(const size_t max_n_open);
+    size_t get_n_open() const;
+    FilePoolStats get_stats() const;
+
+    void close_all();
+
+    /**
+     * Pool shared by ObjectList loads that do not pass their own.
+     */
+    static FilePool& get_global();
+
+private:
+    using LruList = std::list<std::string>;
+
+    struct Entry
+    {
+	std::unique_ptr<TFile> f;
+	LruList::iterator lru_it;
+    };
+
+    void close_least_recently_used();
+
+    size_t max_n_open_;
+    LruList lru_list_;
+    std::unordered_map<std::string, Entry> file_map_;
+    FilePoolStats stats_;
+    mutable std::recursive_mutex mutex_;
+};
+
+
+template<class ObjectType>
+ObjectType* FilePool::read_object(const std::string& spec)
+{
+    TObject* obj = read_object(spec);
+    ObjectType* converted_obj = dynamic_cast<ObjectType*>(obj);
+
+    if (!converted_obj) {
+	fprintf(stderr, "%s is a %s\n", spec.c_str(), obj->ClassName());
+	exit(1);
+    }
+
+    return converted_obj;
+}
+
+
+} // namespace ROOT_helper
+
+
+#endif
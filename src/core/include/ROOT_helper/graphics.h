@@ -2,15 +2,22 @@
 #define ROOT_HELPER_GRAPHICS_H
 
 
+#include <functional>
+#include <map>
+#include <memory>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <TAxis.h>
 #include <TCanvas.h>
 #include <TClass.h>
 #include <TGraph.h>
+#include <TH1.h>
 #include <THLimitsFinder.h>
+#include <THStack.h>
 #include <TMath.h>
 #include <TMultiGraph.h>
 #include <TLatex.h>
@@ -21,6 +28,12 @@
 #include <TString.h>
 #include <TText.h>
 
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/parallel.h>
+#include <ROOT_helper/trace.h>
+#endif
+
 
 namespace ROOT_helper
 {
@@ -28,11 +41,11 @@ namespace ROOT_helper
 class IContainerWrapper;
 
 
-static TLatex kLatex;
-
-
 struct GraphicsSize
 {
+    /**
+     * Size of threads without a bound GraphicsContext, shared by them as before contexts existed.
+     */
     static GraphicsSize current;
 
     unsigned int pad_pixel_w; unsigned int pad_pixel_h;
@@ -67,16 +80,145 @@ static const GraphicsSize g_size_10pt {
 };
 
 
+/**
+ * Size of the GraphicsContext bound in the calling thread, or GraphicsSize::current if none is bound.
+ */
+GraphicsSize& get_current_graphics_size();
+
+
 void prepare();
 
 
+/**
+ * Template used by draw_latex_ndc in the calling thread: that of the bound GraphicsContext, or one shared by unbound threads.
+ */
+TLatex& get_latex_template();
+
+
+/**
+ * The shared template, kept for macros that set its properties directly.
+ */
+static TLatex& kLatex = get_latex_template();
+
+
+/**
+ * Graphics state of one canvas-producing thread: size preset, latex template and target pad.
+ */
+struct GraphicsContext
+{
+    GraphicsContext(const GraphicsSize& size=g_size_8pt);
+
+    GraphicsSize size;
+    TLatex latex;
+    TVirtualPad* pad = nullptr;
+};
+
+
+/**
+ * Makes the context current for the calling thread until destruction.
+ * Changes made to the current size while bound go to the context; gPad is written back to it at destruction.
+ */
+class GraphicsContextBinding
+{
+public:
+    GraphicsContextBinding(GraphicsContext& context);
+    ~GraphicsContextBinding();
+
+    GraphicsContextBinding(const GraphicsContextBinding&) = delete;
+    GraphicsContextBinding& operator=(const GraphicsContextBinding&) = delete;
+
+private:
+    GraphicsContext& context_;
+    GraphicsSize* size_saved_;
+    TLatex* latex_saved_;
+    TVirtualPad* pad_saved_;
+};
+
+
+/**
+ * Calls enable_thread_safety() (thread-local gPad and gDirectory), and enables batch mode for the whole process if is_batch.
+ * Canvases built concurrently need unique names, and printing them is serialized by DataSaver.
+ * Painting (axis styling, Update, Print) uses global TTF and TGaxis state and must still run one thread at a time.
+ */
+void enable_parallel_graphics(const bool is_batch);
+
+
 static std::pair<unsigned int, unsigned int> get_default_n_pad(const unsigned int n_plot);
 
 
-TCanvas* create_canvas(const std::string& name, const std::string& title, const unsigned int n_pad_x=1, const unsigned int n_pad_y=1, const unsigned int each_size_x=GraphicsSize::current.pad_pixel_w, const unsigned int each_size_y=GraphicsSize::current.pad_pixel_h);
+TCanvas* create_canvas(const std::string& name, const std::string& title, const unsigned int n_pad_x=1, const unsigned int n_pad_y=1, const unsigned int each_size_x=get_current_graphics_size().pad_pixel_w, const unsigned int each_size_y=get_current_graphics_size().pad_pixel_h);
+
 
+TCanvas* create_canvas_with_default_pad_matrix(const std::string& name, const std::string& title, const unsigned int n_pad=1, const unsigned int each_size_x=get_current_graphics_size().pad_pixel_h, const unsigned int each_size_y=get_current_graphics_size().pad_pixel_h);
 
-TCanvas* create_canvas_with_default_pad_matrix(const std::string& name, const std::string& title, const unsigned int n_pad=1, const unsigned int each_size_x=GraphicsSize::current.pad_pixel_h, const unsigned int each_size_y=GraphicsSize::current.pad_pixel_h);
+
+/**
+ * Reuses canvases divided with the same geometry instead of allocating a new TCanvas per plot.
+ * Each pooled canvas has its own ObjectRegistry for the lines, legends and latex drawn by the helpers on it.
+ * release() frees them, clears the primitives of every pad, and restores the margins and log scales the pads had when created.
+ * Pooled canvases are deleted with the pool.
+ */
+class CanvasPool
+{
+public:
+    CanvasPool() = default;
+    ~CanvasPool();
+
+    CanvasPool(const CanvasPool&) = delete;
+    CanvasPool& operator=(const CanvasPool&) = delete;
+
+    TCanvas* acquire(const std::string& name, const std::string& title, const unsigned int n_pad_x=1, const unsigned int n_pad_y=1, const unsigned int each_size_x=get_current_graphics_size().pad_pixel_w, const unsigned int each_size_y=get_current_graphics_size().pad_pixel_h);
+
+    void release(TCanvas* c);
+
+    size_t get_n_created() const { return n_created_; }
+    size_t get_n_reused() const { return n_reused_; }
+
+    static bool is_pooled(const TCanvas* c);
+
+    /**
+     * Registry of a pooled canvas, or nullptr.
+     */
+    static ObjectRegistry* get_registry(const TCanvas* c);
+
+private:
+    struct Geometry
+    {
+	unsigned int n_pad_x; unsigned int n_pad_y;
+	unsigned int each_size_x; unsigned int each_size_y;
+
+	bool operator<(const Geometry& other) const
+	{
+	    return std::tie(n_pad_x, n_pad_y, each_size_x, each_size_y) < std::tie(other.n_pad_x, other.n_pad_y, other.each_size_x, other.each_size_y);
+	}
+    };
+
+    struct PadState
+    {
+	TVirtualPad* pad;
+	double top_margin; double right_margin; double bottom_margin; double left_margin;
+	int logx; int logy; int logz;
+    };
+
+    struct PooledCanvas
+    {
+	Geometry geometry;
+	std::vector<PadState> pad_state_list;
+	std::unique_ptr<ObjectRegistry> registry;
+    };
+
+    std::map<TCanvas*, PooledCanvas> canvas_list_;
+    std::map<Geometry, std::vector<TCanvas*>> free_list_;
+    size_t n_created_ = 0;
+    size_t n_reused_ = 0;
+};
+
+
+/**
+ * Hands obj over to the registry of the pooled canvas gPad belongs to, otherwise to the current ObjectRegistryScope.
+ * Without either, obj stays with the caller.
+ */
+void own_helper_object(TObject* obj);
 
 
 Color_t get_color_in_ring(const unsigned int index);
@@ -95,18 +237,21 @@ template<class GraphType>
 double increase_left_margin(GraphType* graph_object, const double scale=1)
 {
     const double current = gPad->GetLeftMargin();
-    const double next = std::max(0., current + scale * GraphicsSize::current.margin_step_horizontal);
+    const double next = std::max(0., current + scale * get_current_graphics_size().margin_step_horizontal);
 
     gPad->SetLeftMargin(next);
-    graph_object->GetYaxis()->SetTitleOffset(graph_object->GetYaxis()->GetTitleOffset() + scale * GraphicsSize::current.title_offset_step_horizontal);
+    graph_object->GetYaxis()->SetTitleOffset(graph_object->GetYaxis()->GetTitleOffset() + scale * get_current_graphics_size().title_offset_step_horizontal);
 
     return next;
 }
 
 
+/**
+ * Auto takes the corner or top/bottom center of the frame covering the fewest points of the graphs and histograms on the pad.
+ */
 enum class LegendPosition
 {
-    TopLeft, TopRight, BottomRight, BottomLeft
+    TopLeft, TopRight, BottomRight, BottomLeft, Auto
 };
 
 
@@ -119,145 +264,87 @@ TLegend* put_legend(LegendPosition leg_pos, Option_t* option="", const double wi
 template<class GraphType>
 void set_x_axis(GraphType* graph_object)
 {
-    gPad->SetRightMargin(GraphicsSize::current.right_margin);
-    gPad->SetBottomMargin(GraphicsSize::current.bottom_margin);
+    gPad->SetRightMargin(get_current_graphics_size().right_margin);
+    gPad->SetBottomMargin(get_current_graphics_size().bottom_margin);
 
     TAxis* axis;
 
     axis = graph_object->GetXaxis();
-    axis->SetTitleSize(GraphicsSize::current.text_size);
-    axis->SetLabelSize(GraphicsSize::current.text_size);
-    axis->SetTitleOffset(GraphicsSize::current.title_offset_x);
+    axis->SetTitleSize(get_current_graphics_size().text_size);
+    axis->SetLabelSize(get_current_graphics_size().text_size);
+    axis->SetTitleOffset(get_current_graphics_size().title_offset_x);
     axis->SetNdivisions(510);
     axis->SetDecimals(true);
     axis->CenterTitle();
 }
 
-double GetMaxLabelWidthNDC(TAxis* axis) {
-  if (!axis || !gPad) return 0.0;
-
-  // 1. Handle Alphanumeric Labels (e.g., "Jan", "Feb")
-  if (axis->GetLabels()) {
-    TText t;
-    t.SetTextFont(axis->GetLabelFont());
-    t.SetTextSize(axis->GetLabelSize());
-    UInt_t maxW = 0, w, h;
-    TIter next(axis->GetLabels());
-    TObject *obj;
-    while ((obj = next())) {
-      t.GetTextExtent(w, h, obj->GetName());
-      if (w > maxW) maxW = w;
-    }
-    return (double)maxW / (gPad->GetWw() * gPad->GetWNDC());
-  }
-
-  // 2. Numerical Labels - Query ROOT's Optimization Engine
-  double xmin = axis->GetXmin();
-  double xmax = axis->GetXmax();
-  int nDivCode = axis->GetNdivisions();
-  int nPrimary = std::abs(nDivCode) % 100;
-
-  double binLow, binHigh, binWidth;
-  int nbins;
-
-  // Check if the user forced divisions (nDivCode < 0 disables optimization)
-  if (nDivCode > 0) {
-    // THIS is the secret sauce ROOT uses to find the "pretty" numbers
-    THLimitsFinder::Optimize(xmin, xmax, nPrimary, binLow, binHigh, nbins, binWidth, "");
-  } else {
-    // Strict, unoptimized mathematical division
-    binLow = xmin;
-    binHigh = xmax;
-    nbins = nPrimary;
-    binWidth = (xmax - xmin) / (double)nbins;
-  }
-
-  // 3. Measure the exact labels ROOT will generate
-  TText t;
-  t.SetTextFont(axis->GetLabelFont());
-  t.SetTextSize(axis->GetLabelSize());
-
-  UInt_t maxW = 0, w, h;
-  int maxDigits = TGaxis::GetMaxDigits();
-
-  for (int i = 0; i <= nbins; ++i) {
-    double val = binLow + i * binWidth;
-    if (std::abs(val) < 1e-10) val = 0.0; // Clean up floating point dust
-
-    TString s;
-    // Mimic ROOT's Scientific Notation switch (e.g., pulling out x10^N)
-    if (val != 0 && (std::abs(val) >= std::pow(10, maxDigits) || std::abs(val) < std::pow(10, -maxDigits))) {
-      int exp = (int)std::floor(std::log10(std::abs(val)));
-      double base = val / std::pow(10, exp);
-      s.Form("%g", base); 
-    } else {
-      s.Form("%g", val);
-    }
 
-    t.GetTextExtent(w, h, s.Data());
-    if (w > maxW) maxW = w;
-  }
+/**
+ * Process-wide caches used by the label layout.
+ * Text extents are keyed by (font, size, string, pad pixel scale), axis optimizations by (xmin, xmax, ndivisions).
+ */
+struct LayoutCacheStats
+{
+    size_t text_extent_hit; size_t text_extent_miss;
+    size_t limits_hit; size_t limits_miss;
+};
 
-  return (double)maxW / (gPad->GetWw() * gPad->GetWNDC());
-}
 
-void OptimizeYAxisLayout(TAxis *yAxis) {
-  if (!yAxis || !gPad) return;
-
-  double labelWidth = GetMaxLabelWidthNDC(yAxis);
-
-  // 2. Fetch current axis properties
-  double tickLength = yAxis->GetTickLength(); // Usually ~0.03
-  double titleSize = yAxis->GetTitleSize();   // Usually ~0.04
-
-  // 3. Calculate the required distance from the axis line
-  // We need space for the ticks, the widest label, and a small visual gap.
-  double gap = 0.010; // 1.5% of pad width for breathing room
-  double distanceFromAxis = tickLength + labelWidth + gap;
-
-  // 4. Calculate and set the Title Offset
-  // Since TitleOffset is a multiplier based on TitleSize, we divide our 
-  // required distance by the TitleSize. The 0.85 is an empirical ROOT tuning 
-  // factor to center the text perfectly.
-  double titleOffset = (distanceFromAxis / titleSize) * 0.70;
-  yAxis->SetTitleOffset(titleOffset);
-
-  // 5. Calculate and set the Left Margin
-  // The margin must fit everything above PLUS the title text itself, 
-  // otherwise the title gets cut off by the edge of the window.
-  double leftEdgeBuffer = 0.000; // Keep it slightly away from the absolute window edge
-  double requiredMargin = distanceFromAxis + titleSize + leftEdgeBuffer;
-
-  // Update the margin (ensure we don't shrink it if it was already intentionally large)
-  if (gPad->GetLeftMargin() < requiredMargin) {
-    gPad->SetLeftMargin(requiredMargin);
-  }
-}
+LayoutCacheStats get_layout_cache_stats();
+
+
+void clear_layout_cache();
+
+
+std::pair<UInt_t, UInt_t> get_text_extent(const Font_t font, const double size, const std::string& text);
+
+
+void optimize_axis_limits(const double x_min, const double x_max, const int n_division, double& bin_low, double& bin_high, int& n_bin, double& bin_width);
+
+
+double GetMaxLabelWidthNDC(TAxis* axis);
+
+
+double get_max_label_width_ndc(TAxis* axis, const double xmin, const double xmax);
+
+
+void OptimizeYAxisLayout(TAxis *yAxis);
+
+
+void apply_y_axis_layout(TAxis *yAxis, const double labelWidth);
+
+
+double GetYaxisLabelWidthNDC(IContainerWrapper *obj);
 
-double GetYaxisLabelWidthNDC(IContainerWrapper *obj) {
-  return 0;
-}
 
 template<class GraphType>
-void set_y_axis(GraphType* graph_object) {
+void style_y_axis(GraphType* graph_object) {
   TAxis* axis;
   axis = graph_object->GetYaxis();
 
-  gPad->SetTopMargin(GraphicsSize::current.top_margin);
+  gPad->SetTopMargin(get_current_graphics_size().top_margin);
 
-  axis->SetTitleSize(GraphicsSize::current.text_size);
-  axis->SetLabelSize(GraphicsSize::current.text_size);
+  axis->SetTitleSize(get_current_graphics_size().text_size);
+  axis->SetLabelSize(get_current_graphics_size().text_size);
   axis->SetNdivisions(505);
   axis->SetDecimals(true);
   axis->CenterTitle();
+}
+
+
+template<class GraphType>
+void set_y_axis(GraphType* graph_object) {
+  style_y_axis(graph_object);
 
-  OptimizeYAxisLayout(axis);
+  OptimizeYAxisLayout(graph_object->GetYaxis());
 }
 
 
 template<class GraphType>
 void set_axes(GraphType* graph_object)
 {
+  ROOT_HELPER_TRACE_SPAN("set_axes");
+
   gPad->Update();
   set_x_axis(graph_object);
   set_y_axis(graph_object);
@@ -272,6 +359,99 @@ TLine* draw_horizontal_line(const double y);
 TLine* draw_vertical_line(const double x);
 
 
+/**
+ * User coordinates of the frame that the painter will use.
+ */
+struct FrameRange
+{
+    double x_min; double x_max;
+    double y_min; double y_max;
+};
+
+
+/**
+ * Computed from the bin contents with the painter's top margin unless the minimum/maximum is set.
+ */
+FrameRange get_frame_range(TH1* h);
+
+
+/**
+ * Requires the stack frame; THStack::GetHistogram() paints the pad once (Modified/Update) if it does not exist yet.
+ */
+FrameRange get_frame_range(THStack* stack);
+
+
+FrameRange get_frame_range(IContainerWrapper* container);
+
+
+/**
+ * From the frame histogram of a TGraph or TMultiGraph. For a TMultiGraph, GetHistogram() may paint the pad to build it.
+ */
+template<class GraphType, class = std::enable_if_t<!std::is_base_of_v<TH1, GraphType> && !std::is_base_of_v<THStack, GraphType> && !std::is_base_of_v<IContainerWrapper, GraphType>>>
+FrameRange get_frame_range(GraphType* graph_object)
+{
+    return get_frame_range(static_cast<TH1*>(graph_object->GetHistogram()));
+}
+
+
+/**
+ * Collects axis styling and decorations for the pads of a canvas, resolves margins,
+ * title offsets, label extents, legend boxes and line ends in memory, and paints each pad once in apply().
+ * The single paint holds for plain graphs and histograms; a THStack or TMultiGraph without a frame yet costs one more to build it.
+ * Pad index 0 is the canvas itself as in TCanvas::cd().
+ */
+class CanvasLayout
+{
+public:
+    CanvasLayout(TCanvas* c);
+
+    template<class GraphType>
+    void set_axes(const int i_pad, GraphType* graph_object);
+
+    void put_legend(const int i_pad, LegendPosition leg_pos, Option_t* option="", const double width=0.3, const double height=0.2);
+
+    void draw_horizontal_line(const int i_pad, const double y);
+
+    void draw_vertical_line(const int i_pad, const double x);
+
+    void draw_latex_ndc(const int i_pad, const double x0, const double y0, const std::string& content);
+
+    void apply();
+
+    TCanvas* get_canvas() const { return canvas_; }
+
+private:
+    struct PadLayout
+    {
+	std::function<FrameRange()> set_axes;
+	std::vector<std::function<void(TVirtualPad*, const FrameRange&)>> decoration_list;
+    };
+
+    TCanvas* canvas_;
+    std::map<int, PadLayout> pad_layout_list_;
+};
+
+
+template<class GraphType>
+void CanvasLayout::set_axes(const int i_pad, GraphType* graph_object)
+{
+    pad_layout_list_[i_pad].set_axes = [graph_object]()
+    {
+	ROOT_HELPER_TRACE_SPAN("CanvasLayout::set_axes");
+
+	const FrameRange range = get_frame_range(graph_object);
+
+	set_x_axis(graph_object);
+	style_y_axis(graph_object);
+
+	TAxis* y_axis = graph_object->GetYaxis();
+	apply_y_axis_layout(y_axis, get_max_label_width_ndc(y_axis, range.y_min, range.y_max));
+
+	return range;
+    };
+}
+
+
 namespace publish 
 {
 
@@ -399,9 +579,15 @@ TMultiGraph* set_graph_marker_styles_by_ring(TMultiGraph* mg);
 TMultiGraph* set_multigraph_axis_from_member(TMultiGraph* mg);
 
 
+/**
+ * Defined in analysis.cpp next to the Span kernel it adapts.
+ */
 double find_x(const TGraph* g, const double y, double x_start=0, double x_end=0);
 
 
+/**
+ * All canvases stay alive; for long object lists, render_pages() in page_renderer.h writes pages from worker processes instead.
+ */
 template<class ObjectType>
 std::vector<TCanvas*> draw_with_auto_recreator_of_canvas(const char* canvas_name_title, const size_t n_pad_x, const size_t n_pad_y, const std::vector<ObjectType*>& object_list, const char* draw_option)
 {
@@ -412,7 +598,7 @@ std::vector<TCanvas*> draw_with_auto_recreator_of_canvas(const char* canvas_name
     for (size_t i = 0; i < object_list.size(); ++i) {
 	TCanvas* c;
 	if (current_pad > n_pad) {
-	    c_list.push_back(new TCanvas(Form("%s_%zu", canvas_name_title, c_list.size()), Form("%s_%zu", canvas_name_title, c_list.size()), 700 * n_pad_x, 500 * n_pad_y));
+	    c_list.push_back(register_in_current_scope(new TCanvas(Form("%s_%zu", canvas_name_title, c_list.size()), Form("%s_%zu", canvas_name_title, c_list.size()), get_current_graphics_size().pad_pixel_w * n_pad_x, get_current_graphics_size().pad_pixel_h * n_pad_y)));
 	    c = c_list.back();
 	    c->Divide(n_pad_x, n_pad_y);
 	    current_pad = 1;
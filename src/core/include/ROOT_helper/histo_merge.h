@@ -0,0 +1,42 @@
+#ifndef ROOT_HELPER_HISTO_MERGE_H
+#define ROOT_HELPER_HISTO_MERGE_H
+
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <TH1.h>
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * Same dimension, number of bins and edges on every axis.
+ */
+bool is_same_binning(const TH1* h0, const TH1* h1);
+
+
+/**
+ * Sums of the histograms at path_list over all files, in the order of path_list.
+ * Binning of every file is checked against the first file in a parallel pass before anything is added,
+ * which reads each file twice; a mismatch or a missing histogram is fatal.
+ * Each of n_thread workers opens its share of the files one at a time and adds them into its own partial sums,
+ * so at most two sets of histograms per thread are in memory. The partial sums are then added pairwise in a tree.
+ * With more than one thread, enable_thread_safety() is called.
+ *
+ *   std::vector<TH1*> h_list = merge_histos(run_file_list, { "h_signal", "h_background" });
+ *   MultiObject stack(MultiObjectType::Histo, "stack", std::vector<TObject*>(h_list.begin(), h_list.end()));
+ */
+std::vector<TH1*> merge_histos(const std::vector<std::filesystem::path>& file_name_list, const std::vector<std::string>& path_list, unsigned int n_thread=0);
+
+
+TH1* merge_histo(const std::vector<std::filesystem::path>& file_name_list, const std::string& path, unsigned int n_thread=0);
+
+
+} // namespace ROOT_helper
+
+
+#endif
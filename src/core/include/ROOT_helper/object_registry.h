@@ -0,0 +1,135 @@
+#ifndef ROOT_HELPER_OBJECT_REGISTRY_H
+#define ROOT_HELPER_OBJECT_REGISTRY_H
+
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <TObject.h>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/parallel.h>
+#endif
+
+
+namespace ROOT_helper
+{
+
+
+struct RegistryStats
+{
+    size_t n_live;
+    size_t n_byte;
+};
+
+
+/**
+ * Object size plus the point and bin arrays of graphs and histograms.
+ */
+size_t estimate_object_size(const TObject* obj);
+
+
+/**
+ * Owns objects allocated by the helpers and deletes them in reverse order on clear() or destruction.
+ * A registered object loses kCanDelete so that a pad does not delete it as well.
+ * It gains kMustCleanup, and the registry is in gROOT's list of cleanups, so an object deleted elsewhere
+ * (a canvas closed in the GUI, a histogram deleted with its directory) is dropped instead of deleted again.
+ */
+class ObjectRegistry
+{
+public:
+    ObjectRegistry();
+    ~ObjectRegistry();
+
+    ObjectRegistry(const ObjectRegistry&) = delete;
+    ObjectRegistry& operator=(const ObjectRegistry&) = delete;
+
+    /**
+     * Adding an object twice has no effect.
+     */
+    void add(TObject* obj);
+
+    /**
+     * Hands obj back to the caller without deleting it.
+     */
+    bool release(TObject* obj);
+
+    void clear();
+
+    RegistryStats get_stats() const;
+
+    /**
+     * Totals over all registries of the process.
+     */
+    static RegistryStats get_global_stats();
+
+    /**
+     * Innermost ObjectRegistryScope of the calling thread, or nullptr.
+     */
+    static ObjectRegistry* get_current();
+
+private:
+    friend class ObjectRegistryScope;
+    friend class ObjectRegistryCleanup;
+
+    /**
+     * Drops obj, which is being deleted by someone else.
+     */
+    void forget(const TObject* obj);
+
+    struct Entry
+    {
+	TObject* obj;
+	size_t n_byte;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Entry> entry_list_;
+    std::unordered_set<const TObject*> object_set_;
+    size_t n_byte_ = 0;
+    std::unique_ptr<TObject> cleanup_;
+};
+
+
+/**
+ * Objects created by the helpers while the scope is alive are freed when it ends.
+ * Scopes nest per thread.
+ *
+ *   {
+ *       ObjectRegistryScope scope;
+ *       draw_horizontal_line(0);
+ *       ...
+ *   }
+ */
+class ObjectRegistryScope
+{
+public:
+    ObjectRegistryScope();
+    ~ObjectRegistryScope();
+
+    ObjectRegistryScope(const ObjectRegistryScope&) = delete;
+    ObjectRegistryScope& operator=(const ObjectRegistryScope&) = delete;
+
+    ObjectRegistry& get_registry() { return registry_; }
+
+private:
+    ObjectRegistry registry_;
+    ObjectRegistry* previous_;
+};
+
+
+template<class ObjectType>
+ObjectType* register_in_current_scope(ObjectType* obj)
+{
+    if (ObjectRegistry* registry = ObjectRegistry::get_current()) registry->add(obj);
+    return obj;
+}
+
+
+} // namespace ROOT_helper
+
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef ROOT_HELPER_PAGE_RENDERER_H
+#define ROOT_HELPER_PAGE_RENDERER_H
+
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <TObject.h>
+
+
+namespace ROOT_helper
+{
+
+
+struct PageLayout
+{
+    std::string canvas_name;
+    unsigned int n_pad_x;
+    unsigned int n_pad_y;
+
+    size_t get_n_pad() const { return n_pad_x * n_pad_y; }
+};
+
+
+/**
+ * What the parent learns about a page written by a worker.
+ */
+struct PageInfo
+{
+    size_t i_page;
+    std::string canvas_name;
+    size_t i_first_object;
+    size_t n_object;
+    std::filesystem::path pdf_path;
+    std::filesystem::path png_path;
+    std::filesystem::path data_path;
+    bool is_written;
+};
+
+
+/**
+ * Splits n_object objects into pages of layout.get_n_pad() pads and renders the pages in n_process forked batch-mode workers.
+ * draw_object(i) draws object i into the current pad; the workers see the objects of the parent through copy-on-write memory.
+ * Each worker writes its pages with its own DataSaver in base_directory, to data_worker_<k>.root unless is_data_saving is false.
+ * A worker reuses one canvas and frees the objects created by the helpers after each page, so its memory does not grow with the number of pages.
+ * n_process=0 uses the hardware concurrency.
+ */
+std::vector<PageInfo> render_pages(const PageLayout& layout, const size_t n_object, const std::function<void(size_t)>& draw_object,
+	const std::filesystem::path& base_directory, const std::filesystem::path& relative_save_directory="",
+	const bool is_data_saving=true, unsigned int n_process=0);
+
+
+template<class ObjectType>
+std::vector<PageInfo> render_pages(const PageLayout& layout, const std::vector<ObjectType*>& object_list, const std::string& draw_option,
+	const std::filesystem::path& base_directory, const std::filesystem::path& relative_save_directory="",
+	const bool is_data_saving=true, unsigned int n_process=0)
+{
+    return render_pages(layout, object_list.size(), [&](const size_t i) { object_list[i]->Draw(draw_option.c_str()); },
+	    base_directory, relative_save_directory, is_data_saving, n_process);
+}
+
+
+template<class T, class ObjectType>
+std::vector<PageInfo> render_pages(const PageLayout& layout, const std::map<T, ObjectType*>& object_map, const std::string& draw_option,
+	const std::filesystem::path& base_directory, const std::filesystem::path& relative_save_directory="",
+	const bool is_data_saving=true, unsigned int n_process=0)
+{
+    std::vector<ObjectType*> object_list;
+    for (const auto& pair : object_map) {
+	object_list.push_back(pair.second);
+    }
+
+    return render_pages(layout, object_list, draw_option, base_directory, relative_save_directory, is_data_saving, n_process);
+}
+
+
+} // namespace ROOT_helper
+
+
+#endif
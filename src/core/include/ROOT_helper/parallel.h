@@ -0,0 +1,102 @@
+#ifndef ROOT_HELPER_PARALLEL_H
+#define ROOT_HELPER_PARALLEL_H
+
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+
+/**
+ * cling does not support thread_local, so the interpreter keeps a single state per process.
+ */
+#ifdef ROOT_HELPER_USED_IN_INTERPRETER
+#define ROOT_HELPER_THREAD_LOCAL
+#else
+#define ROOT_HELPER_THREAD_LOCAL thread_local
+#endif
+
+
+/**
+ * Declared here rather than through TROOT.h, so that parallel.h stays usable by Trace, which does not link ROOT.
+ */
+namespace ROOT
+{
+void EnableThreadSafety();
+}
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * The only place where ROOT_helper calls ROOT::EnableThreadSafety().
+ * It cannot be undone: gDirectory and gPad become thread-local and ROOT locks its global state for the rest of the process.
+ * enable_parallel_graphics, and get_power_spectrum_graphs, get_amplitude_phase_graphs, fit_objects and merge_histos
+ * with more than one thread, call it; call it first thing in a program to make this explicit.
+ */
+inline void enable_thread_safety()
+{
+    ROOT::EnableThreadSafety();
+}
+
+
+inline unsigned int get_default_n_thread()
+{
+    const unsigned int n_hardware = std::thread::hardware_concurrency();
+    return n_hardware > 0 ? n_hardware : 1;
+}
+
+
+/**
+ * Calls func(i) for i in [0, n) on a pool of n_thread workers (0: hardware concurrency).
+ * Indices are handed out in chunks of chunk_size from a shared counter.
+ * Creating or deleting ROOT objects in func requires enable_thread_safety().
+ */
+template<class FunctionType>
+void parallel_for(const size_t n, FunctionType func, unsigned int n_thread=0, size_t chunk_size=1)
+{
+    chunk_size = std::max<size_t>(chunk_size, 1);
+
+    if (n_thread == 0) n_thread = get_default_n_thread();
+    n_thread = std::min<size_t>(n_thread, (n + chunk_size - 1) / chunk_size);
+
+    if (n_thread <= 1) {
+	for (size_t i = 0; i < n; ++i) func(i);
+	return;
+    }
+
+    std::atomic<size_t> next_index { 0 };
+
+    auto worker = [&]()
+    {
+	for (;;) {
+	    const size_t begin = next_index.fetch_add(chunk_size);
+	    if (begin >= n) break;
+
+	    const size_t end = std::min(n, begin + chunk_size);
+	    for (size_t i = begin; i < end; ++i) func(i);
+	}
+    };
+
+    std::vector<std::thread> thread_list;
+    thread_list.reserve(n_thread - 1);
+
+    for (unsigned int i_thread = 1; i_thread < n_thread; ++i_thread) {
+	thread_list.emplace_back(worker);
+    }
+    worker();
+
+    for (auto& thread : thread_list) {
+	thread.join();
+    }
+}
+
+
+} // namespace ROOT_helper
+
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef ROOT_HELPER_STAGE_CACHE_H
+#define ROOT_HELPER_STAGE_CACHE_H
+
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TObject.h>
+
+
+namespace ROOT_helper
+{
+
+
+struct StageCacheStats
+{
+    size_t n_hit = 0;
+    size_t n_miss = 0;
+};
+
+
+/**
+ * Outputs of analysis stages kept in a ROOT file between runs.
+ * A stage is keyed by its name, the MD5 of its inputs serialized with TBufferFile, and a parameter string,
+ * so a change of any input object (contents, name or title) or parameter recomputes it.
+ * Drawing an input does not: its kCanDelete and kMustCleanup bits and attached functions are left out of the key.
+ * Changes of the computation itself are not detected; rename the stage or clear the cache after editing it.
+ * Outputs are detached from any directory and registered in the current ObjectRegistryScope, both on a hit and on a miss.
+ * A cache must not be shared between threads.
+ *
+ *   StageCache cache("stage_cache.root");
+ *   TH1* h_density = cache.get_or_compute<TH1>("density", { h }, make_stage_parameter(scale), [&]()
+ *   {
+ *       return convert_to_density_histo(scale_histo_x(static_cast<TH1*>(h->Clone()), scale));
+ *   });
+ */
+class StageCache
+{
+public:
+    StageCache(const std::filesystem::path& file_name="stage_cache.root");
+    ~StageCache();
+
+    std::string get_key(const std::vector<const TObject*>& input_list, const std::string& parameter="") const;
+
+    TObject* get_or_compute(const std::string& stage_name, const std::vector<const TObject*>& input_list,
+	    const std::string& parameter, const std::function<TObject*()>& compute);
+
+    /**
+     * For stages with several outputs, stored together in one key.
+     */
+    std::vector<TObject*> get_or_compute_list(const std::string& stage_name, const std::vector<const TObject*>& input_list,
+	    const std::string& parameter, const std::function<std::vector<TObject*>()>& compute);
+
+    template<class ObjectType, class FunctionType>
+    ObjectType* get_or_compute(const std::string& stage_name, const std::vector<const TObject*>& input_list,
+	    const std::string& parameter, FunctionType compute);
+
+    /**
+     * Removes all stored stages.
+     */
+    void clear();
+
+    StageCacheStats get_stats() const { return stats_; }
+
+private:
+    TObject* read(const std::string& stage_name, const std::string& key) const;
+    void write(const std::string& stage_name, const std::string& key, TObject* obj);
+
+    std::unique_ptr<TFile> f_;
+    StageCacheStats stats_;
+};
+
+
+template<class ObjectType, class FunctionType>
+ObjectType* StageCache::get_or_compute(const std::string& stage_name, const std::vector<const TObject*>& input_list,
+	const std::string& parameter, FunctionType compute)
+{
+    return static_cast<ObjectType*>(get_or_compute(stage_name, input_list, parameter, [&]() -> TObject* { return compute(); }));
+}
+
+
+/**
+ * Parameter string with exact (hexadecimal) floating-point values.
+ */
+template<class... Ts>
+std::string make_stage_parameter(const Ts&... values)
+{
+    std::ostringstream oss;
+    oss << std::hexfloat;
+    ((oss << values << ';'), ...);
+    return oss.str();
+}
+
+
+} // namespace ROOT_helper
+
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef ROOT_HELPER_TEXT_LOADER_H
+#define ROOT_HELPER_TEXT_LOADER_H
+
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <TGraphErrors.h>
+#include <TH1.h>
+#include <TH2.h>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/container.h>
+#endif
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * Numeric columns of a text file separated by spaces, tabs, commas or semicolons.
+ * Blank lines and lines starting with '#' are skipped, as are non-numeric lines before the first row.
+ * Every row must have the number of columns of the first row.
+ * The file is memory-mapped, split into chunks at line boundaries, and parsed by n_thread threads with std::from_chars.
+ */
+class TextTable
+{
+public:
+    TextTable(const std::filesystem::path& file_name, unsigned int n_thread=0);
+
+    size_t get_n_row() const { return column_list_.empty() ? 0 : column_list_[0].size(); }
+    size_t get_n_column() const { return column_list_.size(); }
+
+    const std::vector<double>& get_column(const size_t i_column) const;
+
+private:
+    std::filesystem::path file_name_;
+    std::vector<std::vector<double>> column_list_;
+};
+
+
+/**
+ * Columns of x, y, ex and ey; negative for no errors.
+ */
+struct ColumnMapping
+{
+    int x = 0;
+    int y = 1;
+    int ex = -1;
+    int ey = -1;
+};
+
+
+TGraphErrors* create_graph_errors(const TextTable& table, const ColumnMapping& mapping={}, const std::string& name="");
+
+
+TGraphErrors* load_graph_errors(const std::filesystem::path& file_name, const ColumnMapping& mapping={}, unsigned int n_thread=0);
+
+
+/**
+ * Filled through bulk_fill_histo; weight_column < 0 fills with unit weights.
+ */
+TH1* fill_histo(TH1* h, const TextTable& table, const int x_column, const int weight_column=-1);
+
+
+TH2* fill_histo(TH2* h, const TextTable& table, const int x_column, const int y_column, const int weight_column=-1);
+
+
+/**
+ * Loads one graph per file, named after the file stem, into object_list. Returns the number of loaded graphs.
+ * The graphs can be drawn together with MultiObject(MultiObjectType::Graph, name, object_list.get_object_list()).
+ */
+int load_graph_errors(ObjectList& object_list, const std::vector<std::filesystem::path>& file_name_list, const ColumnMapping& mapping={}, unsigned int n_thread=0);
+
+
+} // namespace ROOT_helper
+
+
+#endif
@@ -0,0 +1,215 @@
+#ifndef ROOT_HELPER_TIME_SERIES_H
+#define ROOT_HELPER_TIME_SERIES_H
+
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <TGraph.h>
+#include <TMultiGraph.h>
+#include <TVirtualPad.h>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/analysis.h>
+#include <ROOT_helper/graphics.h>
+#endif
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * TGraph whose point count can be changed within the allocated size without reallocation.
+ * It is streamed as a plain TGraph.
+ */
+class FixedCapacityGraph : public TGraph
+{
+public:
+    explicit FixedCapacityGraph(const size_t capacity) : TGraph(capacity) { fNpoints = 0; }
+
+    void set_n_point(const size_t n) { fNpoints = n; }
+};
+
+
+/**
+ * Sliding-window minimum or maximum over the last capacity samples, amortized O(1) per sample.
+ */
+class MonotonicWindow
+{
+public:
+    MonotonicWindow(const size_t capacity, const bool is_max);
+
+    void push(const size_t sequence, const double value);
+
+    /**
+     * Drops the samples older than oldest_sequence.
+     */
+    void expire(const size_t oldest_sequence);
+
+    bool empty() const { return n_ == 0; }
+    double get() const { return value_[head_]; }
+
+private:
+    size_t back() const { return (head_ + n_ - 1) % sequence_.size(); }
+
+    std::vector<size_t> sequence_;
+    std::vector<double> value_;
+    size_t head_ = 0;
+    size_t n_ = 0;
+    bool is_max_;
+};
+
+
+/**
+ * Fixed-capacity ring buffer of (x, y) samples for live monitoring, with x increasing.
+ * Appending is O(1) and never allocates; once full, the oldest sample is overwritten.
+ * The display graph and its axis range are updated in place, at most once per refresh interval.
+ *
+ *   StripChart chart(100000, "g_rate", ";Datetime;Rate (Hz)");
+ *   chart.get_graph()->Draw("AL");
+ *   set_time_x_axis(chart.get_graph());
+ *   while (running) {
+ *       chart.append(t, rate);
+ *       chart.draw_if_due();
+ *   }
+ */
+class StripChart
+{
+public:
+    StripChart(const size_t capacity, const std::string& name="", const std::string& title="");
+    ~StripChart();
+
+    StripChart(const StripChart&) = delete;
+    StripChart& operator=(const StripChart&) = delete;
+
+    void append(const double x, const double y);
+
+    size_t size() const { return n_; }
+    size_t get_capacity() const { return x_.size(); }
+
+    /**
+     * Samples in chronological order as up to two contiguous segments; the second is empty until the buffer wraps.
+     */
+    std::pair<GraphView, GraphView> get_views() const;
+
+    /**
+     * Range of the samples in the buffer, O(1).
+     */
+    FrameRange get_range() const;
+
+    /**
+     * Owned by the chart.
+     */
+    TGraph* get_graph() const { return graph_; }
+
+    /**
+     * Copies the buffer into the display graph and sets the axis range of its histogram without kResetHisto.
+     */
+    void update_graph();
+
+    void set_refresh_interval(const double seconds) { refresh_interval_ = std::chrono::duration<double>(seconds); }
+
+    /**
+     * Updates the graph and repaints pad if the refresh interval has passed since the last repaint.
+     */
+    bool draw_if_due(TVirtualPad* pad=gPad);
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    size_t head_ = 0;
+    size_t n_ = 0;
+    size_t sequence_ = 0;
+    MonotonicWindow y_min_;
+    MonotonicWindow y_max_;
+    FixedCapacityGraph* graph_;
+    std::chrono::duration<double> refresh_interval_ { 0.1 };
+    std::chrono::steady_clock::time_point last_draw_;
+};
+
+
+/**
+ * Sets the axis range of mg to the union of the chart ranges without rebuilding its histogram.
+ */
+void set_strip_chart_range(TMultiGraph* mg, const std::vector<const StripChart*>& chart_list);
+
+
+/**
+ * Min/max envelope of a graph with increasing x, coarsened by a factor of 4 per level and built once.
+ * A query costs O(n_pixel + log n) and returns the minimum and maximum of each bucket in x order.
+ * The graph must outlive the pyramid.
+ */
+class MinMaxPyramid
+{
+public:
+    static constexpr size_t reduction = 4;
+
+    explicit MinMaxPyramid(const TGraph* g);
+
+    size_t get_n_level() const { return level_list_.size() + 1; }
+
+    /**
+     * Resizes out to the envelope of [x_min, x_max] at the finest level with no more than 2 n_pixel buckets in the range.
+     * Raw points are used when there are no more than 2 n_pixel of them.
+     */
+    void fill_graph(TGraph* out, const double x_min, const double x_max, const size_t n_pixel) const;
+
+private:
+    struct Level
+    {
+	size_t bucket_size;
+	std::vector<double> x_at_min; std::vector<double> y_min;
+	std::vector<double> x_at_max; std::vector<double> y_max;
+    };
+
+    GraphView raw_;
+    std::vector<Level> level_list_;
+};
+
+
+/**
+ * Graph to draw in place of a long one. update() refills it for the visible range and pixel width of the pad,
+ * so painting and PDF export cost depend on the pad size instead of the number of points.
+ *
+ *   DownsampledGraph g_display(g_month);
+ *   g_display.get_graph()->Draw("AL");
+ *   set_time_x_axis(g_display.get_graph());
+ *   ... zoom ...
+ *   g_display.update();
+ */
+class DownsampledGraph
+{
+public:
+    explicit DownsampledGraph(const TGraph* g);
+    ~DownsampledGraph();
+
+    DownsampledGraph(const DownsampledGraph&) = delete;
+    DownsampledGraph& operator=(const DownsampledGraph&) = delete;
+
+    /**
+     * Owned by this object.
+     */
+    TGraph* get_graph() const { return graph_; }
+
+    TGraph* update(const double x_min, const double x_max, const size_t n_pixel=get_current_graphics_size().pad_pixel_w);
+
+    /**
+     * Uses the whole x range until the graph has been painted on pad.
+     */
+    TGraph* update(TVirtualPad* pad=gPad);
+
+private:
+    MinMaxPyramid pyramid_;
+    const TGraph* source_;
+    TGraph* graph_;
+};
+
+
+} // namespace ROOT_helper
+
+
+#endif
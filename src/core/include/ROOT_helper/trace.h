@@ -0,0 +1,89 @@
+#ifndef ROOT_HELPER_TRACE_H
+#define ROOT_HELPER_TRACE_H
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/parallel.h>
+#endif
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * Tracing is off unless enabled here or by setting ROOT_HELPER_TRACE to an output file name,
+ * in which case the trace is written there at exit.
+ */
+void enable_trace();
+
+
+void disable_trace();
+
+
+/**
+ * Chrome trace-event JSON, readable by chrome://tracing and Perfetto. Spans recorded so far are kept.
+ */
+void write_trace(const std::string& file_name);
+
+
+void clear_trace();
+
+
+std::atomic<bool>& get_trace_switch();
+
+
+inline bool is_trace_enabled()
+{
+    return get_trace_switch().load(std::memory_order_relaxed);
+}
+
+
+/**
+ * Appends to a per-thread buffer; name must outlive the trace, e.g. a string literal.
+ */
+void record_trace_span(const char* name, const int64_t start_us, const int64_t duration_us);
+
+
+int64_t get_trace_clock_us();
+
+
+/**
+ * Records the lifetime of the scope. When tracing is off, the cost is one relaxed load.
+ */
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char* name)
+    : name_(is_trace_enabled() ? name : nullptr), start_us_(name_ ? get_trace_clock_us() : 0)
+    {
+    }
+
+    ~TraceSpan()
+    {
+	if (name_) record_trace_span(name_, start_us_, get_trace_clock_us() - start_us_);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    int64_t start_us_;
+};
+
+
+} // namespace ROOT_helper
+
+
+#define ROOT_HELPER_TRACE_CONCAT_IMPL(a, b) a##b
+#define ROOT_HELPER_TRACE_CONCAT(a, b) ROOT_HELPER_TRACE_CONCAT_IMPL(a, b)
+#define ROOT_HELPER_TRACE_SPAN(name) ROOT_helper::TraceSpan ROOT_HELPER_TRACE_CONCAT(trace_span_, __LINE__)(name)
+
+
+#endif
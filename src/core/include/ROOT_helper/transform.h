@@ -0,0 +1,400 @@
+#ifndef ROOT_HELPER_TRANSFORM_H
+#define ROOT_HELPER_TRANSFORM_H
+
+
+#include <cmath>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <TAxis.h>
+#include <TGraph.h>
+
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/container.h>
+#include <ROOT_helper/parallel.h>
+#endif
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * Element-wise expressions composed at compile time.
+ * Each node provides value(x) and derivative(x) so that errors are propagated as |f'(x)| * ex.
+ *
+ *   using namespace ROOT_helper::transform;
+ *   transform_graph(g, arg * 1e-3, log10(arg));
+ */
+namespace transform
+{
+
+
+template<class Derived>
+struct Expression
+{ };
+
+
+template<class T>
+constexpr bool is_expression = std::is_base_of_v<Expression<T>, T>;
+
+
+struct Variable : Expression<Variable>
+{
+    double value(const double x) const { return x; }
+    double derivative(const double) const { return 1; }
+};
+
+
+inline constexpr Variable arg {};
+
+
+struct Constant : Expression<Constant>
+{
+    explicit Constant(const double c) : c_(c) { }
+
+    double value(const double) const { return c_; }
+    double derivative(const double) const { return 0; }
+
+    double c_;
+};
+
+
+template<class L, class R>
+struct Sum : Expression<Sum<L, R>>
+{
+    Sum(const L& l, const R& r) : l_(l), r_(r) { }
+
+    double value(const double x) const { return l_.value(x) + r_.value(x); }
+    double derivative(const double x) const { return l_.derivative(x) + r_.derivative(x); }
+
+    L l_; R r_;
+};
+
+
+template<class L, class R>
+struct Difference : Expression<Difference<L, R>>
+{
+    Difference(const L& l, const R& r) : l_(l), r_(r) { }
+
+    double value(const double x) const { return l_.value(x) - r_.value(x); }
+    double derivative(const double x) const { return l_.derivative(x) - r_.derivative(x); }
+
+    L l_; R r_;
+};
+
+
+template<class L, class R>
+struct Product : Expression<Product<L, R>>
+{
+    Product(const L& l, const R& r) : l_(l), r_(r) { }
+
+    double value(const double x) const { return l_.value(x) * r_.value(x); }
+    double derivative(const double x) const { return l_.derivative(x) * r_.value(x) + l_.value(x) * r_.derivative(x); }
+
+    L l_; R r_;
+};
+
+
+template<class L, class R>
+struct Quotient : Expression<Quotient<L, R>>
+{
+    Quotient(const L& l, const R& r) : l_(l), r_(r) { }
+
+    double value(const double x) const { return l_.value(x) / r_.value(x); }
+
+    double derivative(const double x) const
+    {
+	const double r = r_.value(x);
+	return (l_.derivative(x) * r - l_.value(x) * r_.derivative(x)) / (r * r);
+    }
+
+    L l_; R r_;
+};
+
+
+/**
+ * Outer function applied to an inner expression, differentiated with the chain rule.
+ */
+template<class FunctionType, class E>
+struct Composition : Expression<Composition<FunctionType, E>>
+{
+    Composition(const E& e, const FunctionType& f=FunctionType()) : e_(e), f_(f) { }
+
+    double value(const double x) const { return f_.value(e_.value(x)); }
+    double derivative(const double x) const { return f_.derivative(e_.value(x)) * e_.derivative(x); }
+
+    E e_;
+    FunctionType f_;
+};
+
+
+namespace Function
+{
+
+
+struct Negate
+{
+    double value(const double u) const { return -u; }
+    double derivative(const double) const { return -1; }
+};
+
+
+struct Log
+{
+    double value(const double u) const { return std::log(u); }
+    double derivative(const double u) const { return 1 / u; }
+};
+
+
+struct Log10
+{
+    double value(const double u) const { return std::log10(u); }
+    double derivative(const double u) const { return 1 / (u * M_LN10); }
+};
+
+
+struct Exp
+{
+    double value(const double u) const { return std::exp(u); }
+    double derivative(const double u) const { return std::exp(u); }
+};
+
+
+struct Sqrt
+{
+    double value(const double u) const { return std::sqrt(u); }
+    double derivative(const double u) const { return 0.5 / std::sqrt(u); }
+};
+
+
+struct Power
+{
+    double value(const double u) const { return std::pow(u, p_); }
+    double derivative(const double u) const { return p_ * std::pow(u, p_ - 1); }
+
+    double p_;
+};
+
+
+} // namespace Function
+
+
+template<class T>
+auto as_expression(const T& t)
+{
+    if constexpr (is_expression<T>) {
+	return t;
+    } else {
+	return Constant(t);
+    }
+}
+
+
+template<class L, class R>
+constexpr bool is_operand_pair = (is_expression<L> || is_expression<R>)
+    && (is_expression<L> || std::is_arithmetic_v<L>)
+    && (is_expression<R> || std::is_arithmetic_v<R>);
+
+
+template<class L, class R, class = std::enable_if_t<is_operand_pair<L, R>>>
+auto operator+(const L& l, const R& r)
+{
+    return Sum(as_expression(l), as_expression(r));
+}
+
+
+template<class L, class R, class = std::enable_if_t<is_operand_pair<L, R>>>
+auto operator-(const L& l, const R& r)
+{
+    return Difference(as_expression(l), as_expression(r));
+}
+
+
+template<class L, class R, class = std::enable_if_t<is_operand_pair<L, R>>>
+auto operator*(const L& l, const R& r)
+{
+    return Product(as_expression(l), as_expression(r));
+}
+
+
+template<class L, class R, class = std::enable_if_t<is_operand_pair<L, R>>>
+auto operator/(const L& l, const R& r)
+{
+    return Quotient(as_expression(l), as_expression(r));
+}
+
+
+template<class E, class = std::enable_if_t<is_expression<E>>>
+auto operator-(const E& e)
+{
+    return Composition<Function::Negate, E>(e);
+}
+
+
+template<class E, class = std::enable_if_t<is_expression<E>>>
+auto log(const E& e) { return Composition<Function::Log, E>(e); }
+
+
+template<class E, class = std::enable_if_t<is_expression<E>>>
+auto log10(const E& e) { return Composition<Function::Log10, E>(e); }
+
+
+template<class E, class = std::enable_if_t<is_expression<E>>>
+auto exp(const E& e) { return Composition<Function::Exp, E>(e); }
+
+
+template<class E, class = std::enable_if_t<is_expression<E>>>
+auto sqrt(const E& e) { return Composition<Function::Sqrt, E>(e); }
+
+
+template<class E, class = std::enable_if_t<is_expression<E>>>
+auto pow(const E& e, const double p) { return Composition<Function::Power, E>(e, Function::Power { p }); }
+
+
+enum class ErrorLayout
+{
+    None, Symmetric, Asymmetric
+};
+
+
+inline ErrorLayout get_error_layout(const double* e, const double* e_low, const double* e_high)
+{
+    if (e) return ErrorLayout::Symmetric;
+    if (e_low && e_high) return ErrorLayout::Asymmetric;
+    return ErrorLayout::None;
+}
+
+
+/**
+ * A decreasing transform swaps the roles of the low and high errors.
+ */
+template<ErrorLayout layout, class E>
+inline void transform_point(const E& expr, const size_t i, double* v, double* e_low, double* e_high)
+{
+    const double v0 = v[i];
+
+    if constexpr (layout == ErrorLayout::Symmetric) {
+	e_low[i] = std::abs(expr.derivative(v0)) * e_low[i];
+    } else if constexpr (layout == ErrorLayout::Asymmetric) {
+	const double d = expr.derivative(v0);
+	const double abs_d = std::abs(d);
+	const double low = e_low[i];
+	const double high = e_high[i];
+	e_low[i] = abs_d * (d >= 0 ? low : high);
+	e_high[i] = abs_d * (d >= 0 ? high : low);
+    }
+
+    v[i] = expr.value(v0);
+}
+
+
+template<ErrorLayout x_layout, ErrorLayout y_layout, class XExpr, class YExpr>
+void transform_loop(const size_t n,
+	double* __restrict x, double* __restrict ex_low, double* __restrict ex_high,
+	double* __restrict y, double* __restrict ey_low, double* __restrict ey_high,
+	const XExpr& x_expr, const YExpr& y_expr)
+{
+    constexpr bool is_x_identity = std::is_same_v<XExpr, Variable>;
+    constexpr bool is_y_identity = std::is_same_v<YExpr, Variable>;
+
+    for (size_t i = 0; i < n; ++i) {
+	if constexpr (!is_x_identity) transform_point<x_layout>(x_expr, i, x, ex_low, ex_high);
+	if constexpr (!is_y_identity) transform_point<y_layout>(y_expr, i, y, ey_low, ey_high);
+    }
+}
+
+
+template<ErrorLayout x_layout, class XExpr, class YExpr>
+void dispatch_y_layout(const ErrorLayout y_layout, const size_t n,
+	double* x, double* ex_low, double* ex_high, double* y, double* ey_low, double* ey_high,
+	const XExpr& x_expr, const YExpr& y_expr)
+{
+    switch (y_layout) {
+	case ErrorLayout::None:
+	    transform_loop<x_layout, ErrorLayout::None>(n, x, ex_low, ex_high, y, ey_low, ey_high, x_expr, y_expr);
+	    break;
+	case ErrorLayout::Symmetric:
+	    transform_loop<x_layout, ErrorLayout::Symmetric>(n, x, ex_low, ex_high, y, ey_low, ey_high, x_expr, y_expr);
+	    break;
+	case ErrorLayout::Asymmetric:
+	    transform_loop<x_layout, ErrorLayout::Asymmetric>(n, x, ex_low, ex_high, y, ey_low, ey_high, x_expr, y_expr);
+	    break;
+    }
+}
+
+
+/**
+ * Applies x_expr to x and y_expr to y of the graph in one pass, propagating the errors of TGraphErrors and TGraphAsymmErrors.
+ * Empty titles leave the axis titles unchanged.
+ */
+template<class XExpr, class YExpr>
+TGraph* transform_graph(TGraph* g, const XExpr& x_expr, const YExpr& y_expr, const std::string& x_title="", const std::string& y_title="")
+{
+    static_assert(is_expression<XExpr> && is_expression<YExpr>, "use ROOT_helper::transform::arg to build expressions");
+
+    const size_t n = g->GetN();
+
+    double* x = g->GetX();
+    double* y = g->GetY();
+
+    const ErrorLayout x_layout = get_error_layout(g->GetEX(), g->GetEXlow(), g->GetEXhigh());
+    const ErrorLayout y_layout = get_error_layout(g->GetEY(), g->GetEYlow(), g->GetEYhigh());
+
+    double* ex_low = x_layout == ErrorLayout::Symmetric ? g->GetEX() : g->GetEXlow();
+    double* ex_high = x_layout == ErrorLayout::Symmetric ? nullptr : g->GetEXhigh();
+    double* ey_low = y_layout == ErrorLayout::Symmetric ? g->GetEY() : g->GetEYlow();
+    double* ey_high = y_layout == ErrorLayout::Symmetric ? nullptr : g->GetEYhigh();
+
+    switch (x_layout) {
+	case ErrorLayout::None:
+	    dispatch_y_layout<ErrorLayout::None>(y_layout, n, x, ex_low, ex_high, y, ey_low, ey_high, x_expr, y_expr);
+	    break;
+	case ErrorLayout::Symmetric:
+	    dispatch_y_layout<ErrorLayout::Symmetric>(y_layout, n, x, ex_low, ex_high, y, ey_low, ey_high, x_expr, y_expr);
+	    break;
+	case ErrorLayout::Asymmetric:
+	    dispatch_y_layout<ErrorLayout::Asymmetric>(y_layout, n, x, ex_low, ex_high, y, ey_low, ey_high, x_expr, y_expr);
+	    break;
+    }
+
+    if (!x_title.empty()) g->GetXaxis()->SetTitle(x_title.c_str());
+    if (!y_title.empty()) g->GetYaxis()->SetTitle(y_title.c_str());
+    g->SetBit(TGraph::kResetHisto);
+
+    return g;
+}
+
+
+/**
+ * Graphs are processed concurrently; each graph is handled by a single thread.
+ * n_thread=0 uses the hardware concurrency.
+ */
+template<class XExpr, class YExpr>
+void transform_graphs(const std::vector<TGraph*>& graph_list, const XExpr& x_expr, const YExpr& y_expr, unsigned int n_thread=0)
+{
+    parallel_for(graph_list.size(), [&](const size_t i)
+    {
+	transform_graph(graph_list[i], x_expr, y_expr);
+    }, n_thread);
+}
+
+
+/**
+ * Every object of the list must be a TGraph.
+ */
+template<class XExpr, class YExpr>
+void transform_graphs(const ObjectList& object_list, const XExpr& x_expr, const YExpr& y_expr, unsigned int n_thread=0)
+{
+    transform_graphs(object_list.get_checked_object_list<TGraph>(), x_expr, y_expr, n_thread);
+}
+
+
+} // namespace transform
+
+
+} // namespace ROOT_helper
+
+
+#endif
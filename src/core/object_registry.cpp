@@ -0,0 +1,205 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/object_registry.h>
+#endif
+
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <TClass.h>
+#include <TGraph.h>
+#include <TH1.h>
+#include <TObject.h>
+#include <TROOT.h>
+#include <TVirtualMutex.h>
+
+
+namespace ROOT_helper
+{
+
+
+struct GlobalRegistryStats
+{
+    std::atomic<size_t> n_live { 0 };
+    std::atomic<size_t> n_byte { 0 };
+};
+
+
+static GlobalRegistryStats& get_global_registry_stats()
+{
+    static GlobalRegistryStats stats;
+    return stats;
+}
+
+
+static ObjectRegistry*& get_current_registry()
+{
+    static ROOT_HELPER_THREAD_LOCAL ObjectRegistry* current = nullptr;
+    return current;
+}
+
+
+size_t estimate_object_size(const TObject* obj)
+{
+    size_t n_byte = obj->IsA()->Size();
+
+    if (const auto* g = dynamic_cast<const TGraph*>(obj)) {
+	size_t n_array = 2;
+	for (const double* array : { g->GetEX(), g->GetEY(), g->GetEXlow(), g->GetEXhigh(), g->GetEYlow(), g->GetEYhigh() }) {
+	    if (array) ++n_array;
+	}
+	n_byte += n_array * g->GetMaxSize() * sizeof(double);
+    } else if (const auto* h = dynamic_cast<const TH1*>(obj)) {
+	n_byte += h->GetNcells() * sizeof(double);
+	n_byte += h->GetSumw2N() * sizeof(double);
+    }
+
+    return n_byte;
+}
+
+
+/**
+ * Entry of gROOT's list of cleanups through which deletions of kMustCleanup objects reach the registry.
+ */
+class ObjectRegistryCleanup : public TObject
+{
+public:
+    ObjectRegistryCleanup(ObjectRegistry& registry) : registry_(registry) {}
+
+    void RecursiveRemove(TObject* obj) override { registry_.forget(obj); }
+
+private:
+    ObjectRegistry& registry_;
+};
+
+
+ObjectRegistry::ObjectRegistry()
+: cleanup_(new ObjectRegistryCleanup(*this))
+{
+    R__LOCKGUARD(gROOTMutex);
+    gROOT->GetListOfCleanups()->Add(cleanup_.get());
+}
+
+
+ObjectRegistry::~ObjectRegistry()
+{
+    clear();
+
+    R__LOCKGUARD(gROOTMutex);
+    gROOT->GetListOfCleanups()->Remove(cleanup_.get());
+}
+
+
+void ObjectRegistry::add(TObject* obj)
+{
+    if (!obj) return;
+
+    const size_t n_byte = estimate_object_size(obj);
+
+    {
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!object_set_.insert(obj).second) return;
+	entry_list_.push_back({ obj, n_byte });
+	n_byte_ += n_byte;
+    }
+
+    obj->ResetBit(TObject::kCanDelete);
+    obj->SetBit(TObject::kMustCleanup);
+
+    GlobalRegistryStats& global = get_global_registry_stats();
+    ++global.n_live;
+    global.n_byte += n_byte;
+}
+
+
+bool ObjectRegistry::release(TObject* obj)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!object_set_.erase(obj)) return false;
+
+    auto it = std::find_if(entry_list_.rbegin(), entry_list_.rend(), [obj](const Entry& entry) { return entry.obj == obj; });
+
+    const size_t n_byte = it->n_byte;
+    entry_list_.erase(std::next(it).base());
+    n_byte_ -= n_byte;
+
+    GlobalRegistryStats& global = get_global_registry_stats();
+    --global.n_live;
+    global.n_byte -= n_byte;
+
+    return true;
+}
+
+
+void ObjectRegistry::forget(const TObject* obj)
+{
+    release(const_cast<TObject*>(obj));
+}
+
+
+/**
+ * One object at a time, since deleting one may delete others (e.g. the graphs of a multigraph), which are then forgotten.
+ */
+void ObjectRegistry::clear()
+{
+    GlobalRegistryStats& global = get_global_registry_stats();
+
+    for (;;) {
+	Entry entry;
+
+	{
+	    std::lock_guard<std::mutex> lock(mutex_);
+	    if (entry_list_.empty()) break;
+
+	    entry = entry_list_.back();
+	    entry_list_.pop_back();
+	    object_set_.erase(entry.obj);
+	    n_byte_ -= entry.n_byte;
+	}
+
+	--global.n_live;
+	global.n_byte -= entry.n_byte;
+	delete entry.obj;
+    }
+}
+
+
+RegistryStats ObjectRegistry::get_stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return { entry_list_.size(), n_byte_ };
+}
+
+
+RegistryStats ObjectRegistry::get_global_stats()
+{
+    GlobalRegistryStats& global = get_global_registry_stats();
+    return { global.n_live.load(), global.n_byte.load() };
+}
+
+
+ObjectRegistry* ObjectRegistry::get_current()
+{
+    return get_current_registry();
+}
+
+
+ObjectRegistryScope::ObjectRegistryScope()
+: previous_(get_current_registry())
+{
+    get_current_registry() = &registry_;
+}
+
+
+ObjectRegistryScope::~ObjectRegistryScope()
+{
+    get_current_registry() = previous_;
+    registry_.clear();
+}
+
+
+} // namespace ROOT_helper
@@ -0,0 +1,149 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/page_renderer.h>
+#include <ROOT_helper/data_saver.h>
+#include <ROOT_helper/graphics.h>
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/parallel.h>
+#endif
+
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TCanvas.h>
+#include <TROOT.h>
+#include <TString.h>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace ROOT_helper
+{
+
+
+static std::string get_worker_data_file_name(const unsigned int i_process)
+{
+    return Form("data_worker_%u.root", i_process);
+}
+
+
+/**
+ * Runs in the forked child and never returns.
+ */
+[[noreturn]] static void run_page_worker(const PageLayout& layout, const std::vector<PageInfo>& page_list, const std::function<void(size_t)>& draw_object,
+	const std::filesystem::path& base_directory, const std::filesystem::path& relative_save_directory,
+	const bool is_data_saving, const unsigned int i_process, const unsigned int n_process)
+{
+    gROOT->SetBatch(kTRUE);
+
+    {
+	std::unique_ptr<DataSaver> data_saver;
+	if (is_data_saving) data_saver = std::make_unique<DataSaver>(base_directory, true, get_worker_data_file_name(i_process));
+
+	CanvasPool canvas_pool;
+
+	for (size_t i_page = i_process; i_page < page_list.size(); i_page += n_process) {
+	    const PageInfo& page = page_list[i_page];
+
+	    ObjectRegistryScope scope;
+
+	    TCanvas* c = canvas_pool.acquire(page.canvas_name, page.canvas_name, layout.n_pad_x, layout.n_pad_y);
+
+	    for (size_t i = 0; i < page.n_object; ++i) {
+		c->cd(layout.get_n_pad() > 1 ? i + 1 : 0);
+		draw_object(page.i_first_object + i);
+	    }
+	    c->cd();
+
+	    if (data_saver) {
+		data_saver->write_canvas(c, relative_save_directory);
+	    } else {
+		DataSaver::print_canvas(c, base_directory / relative_save_directory);
+	    }
+
+	    canvas_pool.release(c);
+	}
+    }
+
+    fflush(nullptr);
+    _exit(0);
+}
+
+
+std::vector<PageInfo> render_pages(const PageLayout& layout, const size_t n_object, const std::function<void(size_t)>& draw_object,
+	const std::filesystem::path& base_directory, const std::filesystem::path& relative_save_directory,
+	const bool is_data_saving, unsigned int n_process)
+{
+    const size_t n_pad = layout.get_n_pad();
+
+    if (n_pad == 0) {
+	fprintf(stderr, "page layout %s has no pads\n", layout.canvas_name.c_str());
+	exit(1);
+    }
+
+    const size_t n_page = (n_object + n_pad - 1) / n_pad;
+
+    if (n_process == 0) n_process = get_default_n_thread();
+    n_process = std::max<size_t>(1, std::min<size_t>(n_process, n_page));
+
+    const std::filesystem::path write_directory = base_directory / relative_save_directory;
+
+    std::vector<PageInfo> page_list(n_page);
+    for (size_t i_page = 0; i_page < n_page; ++i_page) {
+	PageInfo& page = page_list[i_page];
+	page.i_page = i_page;
+	page.canvas_name = Form("%s_%zu", layout.canvas_name.c_str(), i_page);
+	page.i_first_object = i_page * n_pad;
+	page.n_object = std::min(n_pad, n_object - page.i_first_object);
+	page.pdf_path = write_directory / (page.canvas_name + ".pdf");
+	page.png_path = write_directory / "png" / (page.canvas_name + ".png");
+	if (is_data_saving) page.data_path = base_directory / get_worker_data_file_name(i_page % n_process);
+	page.is_written = false;
+    }
+
+    if (n_page == 0) return page_list;
+
+    std::filesystem::create_directories(write_directory);
+
+    fflush(nullptr);
+
+    std::vector<pid_t> pid_list(n_process);
+    for (unsigned int i_process = 0; i_process < n_process; ++i_process) {
+	const pid_t pid = fork();
+
+	if (pid < 0) {
+	    fprintf(stderr, "failed to fork a page worker\n");
+	    exit(1);
+	}
+
+	if (pid == 0) {
+	    run_page_worker(layout, page_list, draw_object, base_directory, relative_save_directory, is_data_saving, i_process, n_process);
+	}
+
+	pid_list[i_process] = pid;
+    }
+
+    for (unsigned int i_process = 0; i_process < n_process; ++i_process) {
+	int status;
+	waitpid(pid_list[i_process], &status, 0);
+
+	const bool is_succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	if (!is_succeeded) {
+	    fprintf(stderr, "page worker %u of %s failed\n", i_process, layout.canvas_name.c_str());
+	}
+
+	for (size_t i_page = i_process; i_page < n_page; i_page += n_process) {
+	    page_list[i_page].is_written = is_succeeded;
+	}
+    }
+
+    return page_list;
+}
+
+
+} // namespace ROOT_helper
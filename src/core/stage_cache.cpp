@@ -0,0 +1,227 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/stage_cache.h>
+#include <ROOT_helper/data_saver.h>
+#include <ROOT_helper/object_registry.h>
+#include <ROOT_helper/trace.h>
+#endif
+
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <TBufferFile.h>
+#include <TCollection.h>
+#include <TDirectory.h>
+#include <TFile.h>
+#include <TGraph.h>
+#include <TH1.h>
+#include <TList.h>
+#include <TMD5.h>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace ROOT_helper
+{
+
+
+StageCache::StageCache(const std::filesystem::path& file_name)
+{
+    std::lock_guard<std::recursive_mutex> lock(DataSaver::get_output_mutex());
+    TDirectory::TContext context;
+
+    if (file_name.has_parent_path()) std::filesystem::create_directories(file_name.parent_path());
+
+    f_ = std::make_unique<TFile>(file_name.c_str(), "UPDATE");
+
+    if (f_->IsZombie()) {
+	fprintf(stderr, "%s could not be opened as a stage cache\n", file_name.c_str());
+	exit(1);
+    }
+}
+
+
+StageCache::~StageCache()
+{
+    std::lock_guard<std::recursive_mutex> lock(DataSaver::get_output_mutex());
+    TDirectory::TContext context;
+
+    f_->Close();
+}
+
+
+/**
+ * Drops state that changes when an object is drawn rather than when its contents change:
+ * the cleanup and ownership bits, and the functions list where drawing adds a TPaveStats.
+ */
+static void reset_display_state(TObject* obj)
+{
+    obj->ResetBit(TObject::kCanDelete);
+    obj->ResetBit(TObject::kMustCleanup);
+
+    if (auto* h = dynamic_cast<TH1*>(obj)) {
+	h->SetDirectory(nullptr);
+	h->GetListOfFunctions()->Delete();
+    } else if (auto* g = dynamic_cast<TGraph*>(obj)) {
+	g->GetListOfFunctions()->Delete();
+    } else if (auto* collection = dynamic_cast<TCollection*>(obj)) {
+	for (auto* child : *collection) reset_display_state(child);
+    }
+}
+
+
+std::string StageCache::get_key(const std::vector<const TObject*>& input_list, const std::string& parameter) const
+{
+    TMD5 md5;
+    TBufferFile buffer(TBuffer::kWrite);
+    TDirectory::TContext context(nullptr);
+
+    for (const auto* obj : input_list) {
+	if (!obj) {
+	    fprintf(stderr, "null input given to a stage cache\n");
+	    exit(1);
+	}
+
+	std::unique_ptr<TObject> copy(obj->Clone());
+	reset_display_state(copy.get());
+
+	buffer.Reset();
+	buffer.WriteObject(copy.get());
+	md5.Update(reinterpret_cast<const UChar_t*>(buffer.Buffer()), buffer.Length());
+    }
+
+    md5.Update(reinterpret_cast<const UChar_t*>(parameter.data()), parameter.size());
+    md5.Final();
+
+    return md5.AsString();
+}
+
+
+/**
+ * Histograms read from the cache file must not be owned by it, as it may be closed before they are used.
+ * Computed histograms are detached as well, so that they do not belong to whichever directory was current.
+ */
+static void detach_from_directory(TObject* obj)
+{
+    if (auto* h = dynamic_cast<TH1*>(obj)) {
+	h->SetDirectory(nullptr);
+    } else if (auto* collection = dynamic_cast<TCollection*>(obj)) {
+	for (auto* child : *collection) detach_from_directory(child);
+    }
+}
+
+
+TObject* StageCache::read(const std::string& stage_name, const std::string& key) const
+{
+    std::lock_guard<std::recursive_mutex> lock(DataSaver::get_output_mutex());
+
+    TDirectory* directory = f_->GetDirectory(stage_name.c_str());
+    if (!directory) return nullptr;
+
+    TDirectory::TContext context(directory);
+
+    TObject* obj = directory->Get(key.c_str());
+    if (obj) detach_from_directory(obj);
+
+    return obj;
+}
+
+
+void StageCache::write(const std::string& stage_name, const std::string& key, TObject* obj)
+{
+    std::lock_guard<std::recursive_mutex> lock(DataSaver::get_output_mutex());
+    TDirectory::TContext context;
+
+    TDirectory* directory = f_->GetDirectory(stage_name.c_str());
+    if (!directory) directory = f_->mkdir(stage_name.c_str(), "", true);
+
+    directory->WriteTObject(obj, key.c_str(), "SingleKey Overwrite");
+
+    f_->Save();
+}
+
+
+TObject* StageCache::get_or_compute(const std::string& stage_name, const std::vector<const TObject*>& input_list,
+	const std::string& parameter, const std::function<TObject*()>& compute)
+{
+    ROOT_HELPER_TRACE_SPAN("StageCache::get_or_compute");
+
+    const std::string key = get_key(input_list, parameter);
+
+    if (TObject* obj = read(stage_name, key)) {
+	++stats_.n_hit;
+	return register_in_current_scope(obj);
+    }
+
+    ++stats_.n_miss;
+
+    TObject* obj = compute();
+
+    if (!obj) {
+	fprintf(stderr, "stage %s returned no object\n", stage_name.c_str());
+	exit(1);
+    }
+
+    detach_from_directory(obj);
+    write(stage_name, key, obj);
+
+    return register_in_current_scope(obj);
+}
+
+
+std::vector<TObject*> StageCache::get_or_compute_list(const std::string& stage_name, const std::vector<const TObject*>& input_list,
+	const std::string& parameter, const std::function<std::vector<TObject*>()>& compute)
+{
+    ROOT_HELPER_TRACE_SPAN("StageCache::get_or_compute_list");
+
+    const std::string key = get_key(input_list, parameter);
+
+    std::vector<TObject*> obj_list;
+
+    if (auto* list = dynamic_cast<TList*>(read(stage_name, key))) {
+	++stats_.n_hit;
+
+	for (auto* obj : *list) obj_list.emplace_back(register_in_current_scope(obj));
+
+	list->Clear("nodelete");
+	delete list;
+
+	return obj_list;
+    }
+
+    ++stats_.n_miss;
+
+    obj_list = compute();
+
+    TList list;
+    for (auto* obj : obj_list) {
+	detach_from_directory(obj);
+	list.Add(obj);
+    }
+
+    write(stage_name, key, &list);
+
+    list.Clear("nodelete");
+
+    for (auto* obj : obj_list) register_in_current_scope(obj);
+
+    return obj_list;
+}
+
+
+void StageCache::clear()
+{
+    std::lock_guard<std::recursive_mutex> lock(DataSaver::get_output_mutex());
+    TDirectory::TContext context;
+
+    f_->Delete("T*;*");
+    f_->Save();
+
+    stats_ = StageCacheStats();
+}
+
+
+} // namespace ROOT_helper
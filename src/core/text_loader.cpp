@@ -0,0 +1,300 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/text_loader.h>
+#include <ROOT_helper/analysis.h>
+#include <ROOT_helper/container.h>
+#include <ROOT_helper/parallel.h>
+#include <ROOT_helper/trace.h>
+#endif
+
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <TGraphErrors.h>
+#include <TH1.h>
+#include <TH2.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace ROOT_helper
+{
+
+
+/**
+ * Read-only mapping of a whole file, unmapped on destruction.
+ */
+class MappedFile
+{
+public:
+    MappedFile(const std::filesystem::path& file_name)
+    {
+	const int fd = open(file_name.c_str(), O_RDONLY);
+
+	if (fd < 0) {
+	    fprintf(stderr, "%s could not be opened\n", file_name.c_str());
+	    exit(1);
+	}
+
+	struct stat file_stat;
+	fstat(fd, &file_stat);
+	size_ = file_stat.st_size;
+
+	if (size_ > 0) {
+	    void* address = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	    if (address == MAP_FAILED) {
+		fprintf(stderr, "%s could not be memory-mapped\n", file_name.c_str());
+		exit(1);
+	    }
+
+	    madvise(address, size_, MADV_SEQUENTIAL);
+	    data_ = static_cast<const char*>(address);
+	}
+
+	close(fd);
+    }
+
+    ~MappedFile()
+    {
+	if (data_) munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return data_; }
+    const char* end() const { return data_ + size_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+
+static bool is_separator(const char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
+}
+
+
+/**
+ * Parses the numbers of [p, line_end) into value_list, which is cleared first.
+ * Returns false if a field is not a number.
+ */
+static bool parse_line(const char* p, const char* line_end, std::vector<double>& value_list)
+{
+    value_list.clear();
+
+    while (true) {
+	while (p < line_end && is_separator(*p)) ++p;
+	if (p == line_end) return true;
+
+	if (*p == '+') ++p;
+
+	double value;
+	const auto [ next, error ] = std::from_chars(p, line_end, value);
+
+	if (error != std::errc() || (next < line_end && !is_separator(*next))) return false;
+
+	value_list.push_back(value);
+	p = next;
+    }
+}
+
+
+static bool is_skipped_line(const char* p, const char* line_end)
+{
+    while (p < line_end && is_separator(*p)) ++p;
+    return p == line_end || *p == '#';
+}
+
+
+static const char* find_line_end(const char* p, const char* end)
+{
+    const void* found = std::memchr(p, '\n', end - p);
+    return found ? static_cast<const char*>(found) : end;
+}
+
+
+struct ParsedChunk
+{
+    std::vector<std::vector<double>> column_list;
+    const char* error_line = nullptr;
+};
+
+
+static void parse_chunk(const char* begin, const char* end, const size_t n_column, ParsedChunk& chunk)
+{
+    chunk.column_list.assign(n_column, {});
+    for (auto& column : chunk.column_list) column.reserve((end - begin) / (8 * n_column) + 1);
+
+    std::vector<double> value_list;
+    value_list.reserve(n_column);
+
+    for (const char* p = begin; p < end; ) {
+	const char* line_end = find_line_end(p, end);
+
+	if (!is_skipped_line(p, line_end)) {
+	    if (!parse_line(p, line_end, value_list) || value_list.size() != n_column) {
+		chunk.error_line = p;
+		return;
+	    }
+
+	    for (size_t i = 0; i < n_column; ++i) chunk.column_list[i].push_back(value_list[i]);
+	}
+
+	p = line_end + 1;
+    }
+}
+
+
+TextTable::TextTable(const std::filesystem::path& file_name, unsigned int n_thread)
+: file_name_(file_name)
+{
+    ROOT_HELPER_TRACE_SPAN("TextTable::TextTable");
+
+    const MappedFile file(file_name);
+
+    const char* data_begin = file.begin();
+    const char* end = file.end();
+
+    size_t n_column = 0;
+    std::vector<double> value_list;
+
+    while (data_begin < end) {
+	const char* line_end = find_line_end(data_begin, end);
+
+	if (!is_skipped_line(data_begin, line_end) && parse_line(data_begin, line_end, value_list)) {
+	    n_column = value_list.size();
+	    break;
+	}
+
+	data_begin = line_end + 1;
+    }
+
+    if (n_column == 0) return;
+
+    if (n_thread == 0) n_thread = get_default_n_thread();
+
+    const size_t n_byte = end - data_begin;
+    const size_t n_chunk = std::max<size_t>(1, std::min<size_t>(4 * n_thread, n_byte / (1 << 20)));
+
+    std::vector<const char*> boundary_list(n_chunk + 1, end);
+    boundary_list[0] = data_begin;
+    for (size_t i_chunk = 1; i_chunk < n_chunk; ++i_chunk) {
+	const char* p = std::max(boundary_list[i_chunk - 1], data_begin + n_byte * i_chunk / n_chunk);
+	const char* line_end = p < end ? find_line_end(p, end) : end;
+	boundary_list[i_chunk] = line_end < end ? line_end + 1 : end;
+    }
+
+    std::vector<ParsedChunk> chunk_list(n_chunk);
+
+    parallel_for(n_chunk, [&](const size_t i_chunk)
+    {
+	parse_chunk(boundary_list[i_chunk], boundary_list[i_chunk + 1], n_column, chunk_list[i_chunk]);
+    }, n_thread);
+
+    size_t n_row = 0;
+    for (const auto& chunk : chunk_list) {
+	if (chunk.error_line) {
+	    const char* line_end = find_line_end(chunk.error_line, end);
+	    fprintf(stderr, "%s: expected %zu numeric columns at byte %zu: %.*s\n", file_name.c_str(), n_column,
+		    static_cast<size_t>(chunk.error_line - file.begin()), static_cast<int>(std::min<size_t>(line_end - chunk.error_line, 80)), chunk.error_line);
+	    exit(1);
+	}
+	n_row += chunk.column_list[0].size();
+    }
+
+    column_list_.assign(n_column, std::vector<double>(n_row));
+
+    std::vector<size_t> offset_list(n_chunk, 0);
+    for (size_t i_chunk = 1; i_chunk < n_chunk; ++i_chunk) {
+	offset_list[i_chunk] = offset_list[i_chunk - 1] + chunk_list[i_chunk - 1].column_list[0].size();
+    }
+
+    parallel_for(n_chunk, [&](const size_t i_chunk)
+    {
+	for (size_t i_column = 0; i_column < n_column; ++i_column) {
+	    const auto& source = chunk_list[i_chunk].column_list[i_column];
+	    std::copy(source.begin(), source.end(), column_list_[i_column].begin() + offset_list[i_chunk]);
+	}
+    }, n_thread);
+}
+
+
+const std::vector<double>& TextTable::get_column(const size_t i_column) const
+{
+    if (i_column >= column_list_.size()) {
+	fprintf(stderr, "%s has %zu columns, column %zu was requested\n", file_name_.c_str(), column_list_.size(), i_column);
+	exit(1);
+    }
+
+    return column_list_[i_column];
+}
+
+
+TGraphErrors* create_graph_errors(const TextTable& table, const ColumnMapping& mapping, const std::string& name)
+{
+    const size_t n = table.get_n_row();
+
+    TGraphErrors* g = new TGraphErrors(n);
+    g->SetName(name.c_str());
+
+    std::copy_n(table.get_column(mapping.x).begin(), n, g->GetX());
+    std::copy_n(table.get_column(mapping.y).begin(), n, g->GetY());
+    if (mapping.ex >= 0) std::copy_n(table.get_column(mapping.ex).begin(), n, g->GetEX());
+    if (mapping.ey >= 0) std::copy_n(table.get_column(mapping.ey).begin(), n, g->GetEY());
+
+    return g;
+}
+
+
+TGraphErrors* load_graph_errors(const std::filesystem::path& file_name, const ColumnMapping& mapping, unsigned int n_thread)
+{
+    const TextTable table(file_name, n_thread);
+    return create_graph_errors(table, mapping, file_name.stem().string());
+}
+
+
+TH1* fill_histo(TH1* h, const TextTable& table, const int x_column, const int weight_column)
+{
+    ROOT_HELPER_TRACE_SPAN("fill_histo");
+
+    if (weight_column < 0) return bulk_fill_histo(h, table.get_column(x_column));
+
+    return bulk_fill_histo(h, table.get_column(x_column), table.get_column(weight_column));
+}
+
+
+TH2* fill_histo(TH2* h, const TextTable& table, const int x_column, const int y_column, const int weight_column)
+{
+    ROOT_HELPER_TRACE_SPAN("fill_histo");
+
+    if (weight_column < 0) return bulk_fill_histo(h, table.get_column(x_column), table.get_column(y_column));
+
+    return bulk_fill_histo(h, table.get_column(x_column), table.get_column(y_column), table.get_column(weight_column));
+}
+
+
+int load_graph_errors(ObjectList& object_list, const std::vector<std::filesystem::path>& file_name_list, const ColumnMapping& mapping, unsigned int n_thread)
+{
+    for (const auto& file_name : file_name_list) {
+	TGraphErrors* g = load_graph_errors(file_name, mapping, n_thread);
+	g->SetTitle(g->GetName());
+	object_list.add_object(g);
+    }
+
+    return file_name_list.size();
+}
+
+
+} // namespace ROOT_helper
@@ -0,0 +1,340 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/time_series.h>
+#endif
+
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <cmath>
+#include <vector>
+
+#include <TAxis.h>
+#include <TGraph.h>
+#include <TH1.h>
+#include <TList.h>
+#include <TMultiGraph.h>
+#include <TString.h>
+#include <TVirtualPad.h>
+#include <cstdio>
+#include <cstdlib>
+
+
+namespace ROOT_helper
+{
+
+
+MonotonicWindow::MonotonicWindow(const size_t capacity, const bool is_max)
+: sequence_(capacity), value_(capacity), is_max_(is_max)
+{
+}
+
+
+void MonotonicWindow::push(const size_t sequence, const double value)
+{
+    while (n_ > 0 && (is_max_ ? value_[back()] <= value : value_[back()] >= value)) --n_;
+
+    const size_t i = (head_ + n_) % sequence_.size();
+    sequence_[i] = sequence;
+    value_[i] = value;
+    ++n_;
+}
+
+
+void MonotonicWindow::expire(const size_t oldest_sequence)
+{
+    while (n_ > 0 && sequence_[head_] < oldest_sequence) {
+	head_ = (head_ + 1) % sequence_.size();
+	--n_;
+    }
+}
+
+
+StripChart::StripChart(const size_t capacity, const std::string& name, const std::string& title)
+: x_(capacity), y_(capacity), y_min_(capacity, false), y_max_(capacity, true), graph_(new FixedCapacityGraph(capacity))
+{
+    if (capacity == 0) {
+	fprintf(stderr, "strip chart %s needs a non-zero capacity\n", name.c_str());
+	exit(1);
+    }
+
+    graph_->SetNameTitle(name.c_str(), title.c_str());
+}
+
+
+StripChart::~StripChart()
+{
+    delete graph_;
+}
+
+
+void StripChart::append(const double x, const double y)
+{
+    const size_t capacity = x_.size();
+    const size_t i = (head_ + n_) % capacity;
+
+    x_[i] = x;
+    y_[i] = y;
+
+    if (n_ < capacity) {
+	++n_;
+    } else {
+	head_ = (head_ + 1) % capacity;
+    }
+
+    const size_t oldest_sequence = sequence_ + 1 - n_;
+    y_min_.expire(oldest_sequence);
+    y_max_.expire(oldest_sequence);
+
+    y_min_.push(sequence_, y);
+    y_max_.push(sequence_, y);
+    ++sequence_;
+}
+
+
+std::pair<GraphView, GraphView> StripChart::get_views() const
+{
+    const size_t n_first = std::min(n_, x_.size() - head_);
+    const size_t n_second = n_ - n_first;
+
+    return {
+	GraphView { Span<const double>(x_.data() + head_, n_first), Span<const double>(y_.data() + head_, n_first), {}, {} },
+	GraphView { Span<const double>(x_.data(), n_second), Span<const double>(y_.data(), n_second), {}, {} }
+    };
+}
+
+
+FrameRange StripChart::get_range() const
+{
+    if (n_ == 0) return { 0, 1, 0, 1 };
+
+    const size_t i_newest = (head_ + n_ - 1) % x_.size();
+
+    return { x_[head_], x_[i_newest], y_min_.get(), y_max_.get() };
+}
+
+
+void StripChart::update_graph()
+{
+    const auto [ first, second ] = get_views();
+
+    std::copy(first.x.begin(), first.x.end(), graph_->GetX());
+    std::copy(first.y.begin(), first.y.end(), graph_->GetY());
+    std::copy(second.x.begin(), second.x.end(), graph_->GetX() + first.size());
+    std::copy(second.y.begin(), second.y.end(), graph_->GetY() + first.size());
+    graph_->set_n_point(n_);
+
+    if (n_ == 0) return;
+
+    const FrameRange range = get_range();
+    const double y_margin = std::max(0.05 * (range.y_max - range.y_min), 1e-9 * std::max(1., std::abs(range.y_max)));
+
+    TH1* h = graph_->GetHistogram();
+    h->GetXaxis()->SetLimits(range.x_min, range.x_max > range.x_min ? range.x_max : range.x_min + 1);
+    h->SetMinimum(range.y_min - y_margin);
+    h->SetMaximum(range.y_max + y_margin);
+}
+
+
+bool StripChart::draw_if_due(TVirtualPad* pad)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - last_draw_ < refresh_interval_) return false;
+
+    last_draw_ = now;
+
+    update_graph();
+
+    if (pad) {
+	pad->Modified();
+	pad->Update();
+    }
+
+    return true;
+}
+
+
+void set_strip_chart_range(TMultiGraph* mg, const std::vector<const StripChart*>& chart_list)
+{
+    FrameRange range { 0, 0, 0, 0 };
+    bool is_empty = true;
+
+    for (const auto* chart : chart_list) {
+	if (chart->size() == 0) continue;
+
+	const FrameRange chart_range = chart->get_range();
+
+	if (is_empty) {
+	    range = chart_range;
+	    is_empty = false;
+	} else {
+	    range.x_min = std::min(range.x_min, chart_range.x_min);
+	    range.x_max = std::max(range.x_max, chart_range.x_max);
+	    range.y_min = std::min(range.y_min, chart_range.y_min);
+	    range.y_max = std::max(range.y_max, chart_range.y_max);
+	}
+    }
+
+    if (is_empty) return;
+
+    const double y_margin = std::max(0.05 * (range.y_max - range.y_min), 1e-9 * std::max(1., std::abs(range.y_max)));
+
+    TH1* h = mg->GetHistogram();
+    h->GetXaxis()->SetLimits(range.x_min, range.x_max > range.x_min ? range.x_max : range.x_min + 1);
+    mg->SetMinimum(range.y_min - y_margin);
+    mg->SetMaximum(range.y_max + y_margin);
+}
+
+
+MinMaxPyramid::MinMaxPyramid(const TGraph* g)
+: raw_(make_graph_view(g))
+{
+    const size_t n = raw_.size();
+
+    for (size_t bucket_size = reduction; bucket_size < n * reduction; bucket_size *= reduction) {
+	const size_t n_bucket = (n + bucket_size - 1) / bucket_size;
+
+	Level level { bucket_size, std::vector<double>(n_bucket), std::vector<double>(n_bucket), std::vector<double>(n_bucket), std::vector<double>(n_bucket) };
+
+	const Level* finer = level_list_.empty() ? nullptr : &level_list_.back();
+	const size_t n_finer = finer ? finer->y_min.size() : n;
+
+	for (size_t i_bucket = 0; i_bucket < n_bucket; ++i_bucket) {
+	    const size_t i_begin = i_bucket * reduction;
+	    const size_t i_end = std::min(i_begin + reduction, n_finer);
+
+	    size_t i_min = i_begin;
+	    size_t i_max = i_begin;
+
+	    if (finer) {
+		for (size_t i = i_begin + 1; i < i_end; ++i) {
+		    if (finer->y_min[i] < finer->y_min[i_min]) i_min = i;
+		    if (finer->y_max[i] > finer->y_max[i_max]) i_max = i;
+		}
+		level.x_at_min[i_bucket] = finer->x_at_min[i_min]; level.y_min[i_bucket] = finer->y_min[i_min];
+		level.x_at_max[i_bucket] = finer->x_at_max[i_max]; level.y_max[i_bucket] = finer->y_max[i_max];
+	    } else {
+		for (size_t i = i_begin + 1; i < i_end; ++i) {
+		    if (raw_.y[i] < raw_.y[i_min]) i_min = i;
+		    if (raw_.y[i] > raw_.y[i_max]) i_max = i;
+		}
+		level.x_at_min[i_bucket] = raw_.x[i_min]; level.y_min[i_bucket] = raw_.y[i_min];
+		level.x_at_max[i_bucket] = raw_.x[i_max]; level.y_max[i_bucket] = raw_.y[i_max];
+	    }
+	}
+
+	level_list_.push_back(std::move(level));
+
+	if (n_bucket == 1) break;
+    }
+}
+
+
+/**
+ * The range is widened by one point on each side so that lines reach the pad edges.
+ */
+void MinMaxPyramid::fill_graph(TGraph* out, const double x_min, const double x_max, const size_t n_pixel) const
+{
+    const size_t n = raw_.size();
+
+    const size_t i_begin = std::max<size_t>(std::lower_bound(raw_.x.begin(), raw_.x.end(), x_min) - raw_.x.begin(), 1) - 1;
+    const size_t i_end = std::min<size_t>(std::upper_bound(raw_.x.begin(), raw_.x.end(), x_max) - raw_.x.begin() + 1, n);
+
+    if (i_end <= i_begin) {
+	out->Set(0);
+	return;
+    }
+
+    const size_t n_target = 2 * std::max<size_t>(n_pixel, 1);
+
+    const Level* selected = nullptr;
+    if (i_end - i_begin > n_target) {
+	for (const Level& level : level_list_) {
+	    selected = &level;
+	    if ((i_end - i_begin + level.bucket_size - 1) / level.bucket_size <= n_target) break;
+	}
+    }
+
+    if (!selected) {
+	out->Set(i_end - i_begin);
+	std::copy(raw_.x.begin() + i_begin, raw_.x.begin() + i_end, out->GetX());
+	std::copy(raw_.y.begin() + i_begin, raw_.y.begin() + i_end, out->GetY());
+	return;
+    }
+
+    const size_t b_begin = i_begin / selected->bucket_size;
+    const size_t b_end = (i_end - 1) / selected->bucket_size + 1;
+
+    out->Set(2 * (b_end - b_begin));
+    double* x = out->GetX();
+    double* y = out->GetY();
+
+    for (size_t b = b_begin; b < b_end; ++b) {
+	const bool is_min_first = selected->x_at_min[b] <= selected->x_at_max[b];
+	const size_t i = 2 * (b - b_begin);
+
+	x[i] = is_min_first ? selected->x_at_min[b] : selected->x_at_max[b];
+	y[i] = is_min_first ? selected->y_min[b] : selected->y_max[b];
+	x[i + 1] = is_min_first ? selected->x_at_max[b] : selected->x_at_min[b];
+	y[i + 1] = is_min_first ? selected->y_max[b] : selected->y_min[b];
+    }
+}
+
+
+DownsampledGraph::DownsampledGraph(const TGraph* g)
+: pyramid_(g), source_(g), graph_(new TGraph())
+{
+    graph_->SetNameTitle(Form("%s_downsampled", g->GetName()), g->GetTitle());
+    graph_->GetXaxis()->SetTitle(g->GetXaxis()->GetTitle());
+    graph_->GetYaxis()->SetTitle(g->GetYaxis()->GetTitle());
+    graph_->SetLineColor(g->GetLineColor());
+    graph_->SetLineWidth(g->GetLineWidth());
+    graph_->SetLineStyle(g->GetLineStyle());
+    graph_->SetMarkerColor(g->GetMarkerColor());
+    graph_->SetMarkerStyle(g->GetMarkerStyle());
+
+    const int n = g->GetN();
+    if (n > 0) update(g->GetX()[0], g->GetX()[n - 1]);
+}
+
+
+DownsampledGraph::~DownsampledGraph()
+{
+    delete graph_;
+}
+
+
+TGraph* DownsampledGraph::update(const double x_min, const double x_max, const size_t n_pixel)
+{
+    pyramid_.fill_graph(graph_, x_min, x_max, n_pixel);
+    return graph_;
+}
+
+
+TGraph* DownsampledGraph::update(TVirtualPad* pad)
+{
+    const int n = source_->GetN();
+    if (n == 0) return graph_;
+
+    double x_min = source_->GetX()[0];
+    double x_max = source_->GetX()[n - 1];
+    size_t n_pixel = get_current_graphics_size().pad_pixel_w;
+
+    if (pad && pad->GetListOfPrimitives()->FindObject(graph_) && pad->GetUxmax() > pad->GetUxmin()) {
+	x_min = pad->GetLogx() ? std::pow(10, pad->GetUxmin()) : pad->GetUxmin();
+	x_max = pad->GetLogx() ? std::pow(10, pad->GetUxmax()) : pad->GetUxmax();
+
+	const double frame_fraction = 1.0 - pad->GetLeftMargin() - pad->GetRightMargin();
+	n_pixel = std::max<size_t>(1, pad->GetWw() * pad->GetAbsWNDC() * frame_fraction);
+    }
+
+    update(x_min, x_max, n_pixel);
+
+    if (pad) pad->Modified();
+
+    return graph_;
+}
+
+
+} // namespace ROOT_helper
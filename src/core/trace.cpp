@@ -0,0 +1,188 @@
+#ifndef ROOT_HELPER_USED_IN_INTERPRETER
+#include <ROOT_helper/trace.h>
+#endif
+
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+namespace ROOT_helper
+{
+
+
+struct TraceEvent
+{
+    const char* name;
+    int64_t start_us;
+    int64_t duration_us;
+};
+
+
+struct TraceBuffer
+{
+    std::mutex mutex;
+    std::vector<TraceEvent> event_list;
+    int thread_id;
+};
+
+
+/**
+ * Buffers outlive their threads so that spans of finished workers are exported too.
+ */
+struct TraceRegistry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<TraceBuffer>> buffer_list;
+    std::string output_file_name;
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+};
+
+
+static TraceRegistry& get_trace_registry()
+{
+    static TraceRegistry registry;
+    return registry;
+}
+
+
+static bool write_trace_file(const std::string& file_name);
+
+
+/**
+ * Runs from atexit, where calling exit again is undefined, so a failure is only reported.
+ */
+static void write_trace_at_exit()
+{
+    write_trace_file(get_trace_registry().output_file_name);
+}
+
+
+std::atomic<bool>& get_trace_switch()
+{
+    static std::atomic<bool> trace_switch = []()
+    {
+	const char* file_name = std::getenv("ROOT_HELPER_TRACE");
+
+	if (!file_name || file_name[0] == '\0') return false;
+
+	get_trace_registry().output_file_name = file_name;
+	std::atexit(write_trace_at_exit);
+
+	return true;
+    }();
+
+    return trace_switch;
+}
+
+
+void enable_trace()
+{
+    get_trace_switch().store(true);
+}
+
+
+void disable_trace()
+{
+    get_trace_switch().store(false);
+}
+
+
+int64_t get_trace_clock_us()
+{
+    const auto elapsed = std::chrono::steady_clock::now() - get_trace_registry().origin;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+
+static TraceBuffer& get_thread_trace_buffer()
+{
+    static ROOT_HELPER_THREAD_LOCAL TraceBuffer* buffer = nullptr;
+
+    if (!buffer) {
+	TraceRegistry& registry = get_trace_registry();
+	std::lock_guard<std::mutex> lock(registry.mutex);
+
+	auto new_buffer = std::make_shared<TraceBuffer>();
+	new_buffer->thread_id = registry.buffer_list.size();
+	registry.buffer_list.push_back(new_buffer);
+
+	buffer = new_buffer.get();
+    }
+
+    return *buffer;
+}
+
+
+/**
+ * The buffer mutex is only contended while a trace is written or cleared.
+ */
+void record_trace_span(const char* name, const int64_t start_us, const int64_t duration_us)
+{
+    TraceBuffer& buffer = get_thread_trace_buffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.event_list.push_back({ name, start_us, duration_us });
+}
+
+
+static bool write_trace_file(const std::string& file_name)
+{
+    std::ofstream ofs(file_name);
+
+    if (!ofs) {
+	fprintf(stderr, "trace file %s could not be opened\n", file_name.c_str());
+	return false;
+    }
+
+    TraceRegistry& registry = get_trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+    bool is_first = true;
+    for (const auto& buffer : registry.buffer_list) {
+	std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+
+	for (const auto& event : buffer->event_list) {
+	    if (!is_first) ofs << ",\n";
+	    is_first = false;
+
+	    ofs << "{\"name\": \"" << event.name << "\", \"cat\": \"ROOT_helper\", \"ph\": \"X\""
+		<< ", \"ts\": " << event.start_us << ", \"dur\": " << event.duration_us
+		<< ", \"pid\": 1, \"tid\": " << buffer->thread_id << "}";
+	}
+    }
+
+    ofs << "\n]}\n";
+
+    return true;
+}
+
+
+void write_trace(const std::string& file_name)
+{
+    if (!write_trace_file(file_name)) exit(1);
+}
+
+
+void clear_trace()
+{
+    TraceRegistry& registry = get_trace_registry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    for (const auto& buffer : registry.buffer_list) {
+	std::lock_guard<std::mutex> buffer_lock(buffer->mutex);
+	buffer->event_list.clear();
+    }
+}
+
+
+} // namespace ROOT_helper
@@ -0,0 +1,110 @@
+#include <ROOT_helper/ROOT_helper.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <TCanvas.h>
+#include <TGraph.h>
+#include <TMath.h>
+
+
+namespace rh = ROOT_helper;
+
+
+/**
+ * Axis styling and painting go through global TTF and TGaxis state, so they run under paint_mutex.
+ * Only building the canvases, pads and graphs is parallel; the time spent holding the lock is reported.
+ */
+std::mutex paint_mutex;
+double t_serialized = 0;
+
+
+/**
+ * Builds a styled 2x2 canvas of sine graphs in the calling thread.
+ */
+TCanvas* build_canvas(const size_t i_canvas, const int n_point);
+
+
+int main(int argc, char** argv)
+{
+    const size_t n_canvas = argc > 1 ? std::atoi(argv[1]) : 256;
+    const int n_point = argc > 2 ? std::atoi(argv[2]) : 1000;
+
+    rh::prepare();
+    rh::enable_parallel_graphics(true);
+
+    std::cout << n_canvas << " canvases with 4 pads x " << n_point << " points" << std::endl;
+
+    double t_single = 0;
+
+    for (unsigned int n_thread = 1; n_thread <= rh::get_default_n_thread(); n_thread *= 2) {
+	std::vector<TCanvas*> canvas_list(n_canvas);
+	t_serialized = 0;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	rh::parallel_for(n_thread, [&](const size_t i_thread)
+	{
+	    rh::GraphicsContext context(rh::g_size_8pt);
+	    rh::GraphicsContextBinding binding(context);
+
+	    for (size_t i_canvas = i_thread; i_canvas < n_canvas; i_canvas += n_thread) {
+		canvas_list[i_canvas] = build_canvas(i_canvas, n_point);
+	    }
+	}, n_thread);
+
+	const auto stop = std::chrono::steady_clock::now();
+	const double t = std::chrono::duration<double>(stop - start).count();
+	if (n_thread == 1) t_single = t;
+
+	std::cout << n_thread << " threads: " << t << " s (x" << t_single / t << "), " << t_serialized << " s serialized" << std::endl;
+
+	for (auto* c : canvas_list) delete c;
+    }
+
+    return 0;
+}
+
+
+TCanvas* build_canvas(const size_t i_canvas, const int n_point)
+{
+    const std::string name = "c_bench_" + std::to_string(i_canvas);
+    TCanvas* c = rh::create_canvas(name, name, 2, 2);
+
+    TGraph* g_list[4];
+
+    for (int i_pad = 1; i_pad <= 4; ++i_pad) {
+	c->cd(i_pad);
+
+	TGraph* g = new TGraph(n_point);
+	g->SetTitle(Form("wave %d;Time (s);Amplitude (V)", i_pad));
+	for (int i = 0; i < n_point; ++i) {
+	    const double t = static_cast<double>(i) / n_point;
+	    g->SetPoint(i, t, i_pad * TMath::Sin(TMath::TwoPi() * i_pad * t));
+	}
+	g->SetLineColor(rh::get_color_in_ring(i_pad - 1));
+	g->SetBit(TObject::kCanDelete);
+	g->Draw("AL");
+
+	g_list[i_pad - 1] = g;
+    }
+
+    std::lock_guard<std::mutex> lock(paint_mutex);
+    const auto start = std::chrono::steady_clock::now();
+
+    for (int i_pad = 1; i_pad <= 4; ++i_pad) {
+	c->cd(i_pad);
+	rh::set_axes(g_list[i_pad - 1]);
+	rh::draw_latex_ndc(0.6, 0.85, Form("pad %d", i_pad));
+    }
+
+    c->Update();
+
+    t_serialized += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return c;
+}
@@ -0,0 +1,347 @@
+#include <ROOT_helper/ROOT_helper.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <TCanvas.h>
+#include <TFile.h>
+#include <TGraph.h>
+#include <TGraphErrors.h>
+#include <TH1.h>
+#include <TMath.h>
+#include <TRandom3.h>
+#include <TROOT.h>
+
+
+namespace rh = ROOT_helper;
+
+
+struct BenchResult
+{
+    std::string name;
+    int size;
+    std::vector<double> second_list;
+};
+
+
+/**
+ * setup() runs before each repetition outside the measurement; run() is measured.
+ */
+struct BenchCase
+{
+    std::string name;
+    std::function<void(int)> setup;
+    std::function<void(int)> run;
+    std::function<void()> teardown;
+};
+
+
+std::vector<BenchCase> create_bench_case_list(const std::filesystem::path& output_directory);
+
+
+void write_json(const std::string& file_name, const std::vector<BenchResult>& result_list, const int n_repetition);
+
+
+/**
+ * ROOThelperBench [output.json] [n_repetition] [size...]
+ */
+int main(int argc, char** argv)
+{
+    const std::string json_file_name = argc > 1 ? argv[1] : "bench_root_helper.json";
+    const int n_repetition = argc > 2 ? std::atoi(argv[2]) : 5;
+
+    if (n_repetition < 1) {
+	fprintf(stderr, "n_repetition must be at least 1\n");
+	exit(1);
+    }
+
+    std::vector<int> size_list;
+    for (int i = 3; i < argc; ++i) size_list.push_back(std::atoi(argv[i]));
+    if (size_list.empty()) size_list = { 100, 1000, 10000 };
+
+    gROOT->SetBatch(kTRUE);
+    TH1::AddDirectory(kFALSE);
+    rh::prepare();
+
+    const std::filesystem::path output_directory = std::filesystem::temp_directory_path() / "ROOThelperBench";
+    std::filesystem::remove_all(output_directory);
+
+    std::vector<BenchResult> result_list;
+
+    for (const auto& bench_case : create_bench_case_list(output_directory)) {
+	for (const int size : size_list) {
+	    BenchResult result { bench_case.name, size, {} };
+
+	    for (int i_repetition = 0; i_repetition < n_repetition; ++i_repetition) {
+		if (bench_case.setup) bench_case.setup(size);
+
+		const auto start = std::chrono::steady_clock::now();
+		bench_case.run(size);
+		const auto stop = std::chrono::steady_clock::now();
+
+		if (bench_case.teardown) bench_case.teardown();
+
+		result.second_list.push_back(std::chrono::duration<double>(stop - start).count());
+	    }
+
+	    std::cout << bench_case.name << " " << size << ": " << *std::min_element(result.second_list.begin(), result.second_list.end()) << " s" << std::endl;
+
+	    result_list.push_back(result);
+	}
+    }
+
+    write_json(json_file_name, result_list, n_repetition);
+
+    std::filesystem::remove_all(output_directory);
+
+    return 0;
+}
+
+
+TGraph* create_sine_graph(const int n_point, const double phase=0)
+{
+    TGraph* g = new TGraph(n_point);
+    for (int i = 0; i < n_point; ++i) {
+	const double x = static_cast<double>(i) / n_point;
+	g->SetPoint(i, x, TMath::Sin(TMath::TwoPi() * x + phase));
+    }
+    g->GetXaxis()->SetTitle("Time (s)");
+    g->GetYaxis()->SetTitle("Amplitude (V)");
+    return g;
+}
+
+
+TGraphErrors* create_graph_errors(const int n_point, TRandom3& random)
+{
+    TGraphErrors* g = new TGraphErrors(n_point);
+    for (int i = 0; i < n_point; ++i) {
+	g->SetPoint(i, i, random.Gaus(0, 1));
+	g->SetPointError(i, 0.5, random.Uniform(0.1, 0.2));
+    }
+    return g;
+}
+
+
+TH1D* create_variable_bin_histo(const std::string& name, const int n_bin, TRandom3& random)
+{
+    std::vector<double> edges(n_bin + 1);
+    for (int i = 0; i <= n_bin; ++i) edges[i] = i + 0.5 * TMath::Sin(i);
+
+    TH1D* h = new TH1D(name.c_str(), name.c_str(), n_bin, edges.data());
+    for (int i = 1; i <= n_bin; ++i) {
+	h->SetBinContent(i, random.Poisson(100));
+	h->SetBinError(i, 10);
+    }
+    return h;
+}
+
+
+/**
+ * Sizes are points per graph or bins per histogram, except for the object lists where they count objects and the bulk fill where they count entries.
+ */
+std::vector<BenchCase> create_bench_case_list(const std::filesystem::path& output_directory)
+{
+    static TRandom3 random(1);
+    static TCanvas* c = nullptr;
+    static TGraph* g = nullptr;
+    static TGraphErrors* g0 = nullptr;
+    static TGraphErrors* g1 = nullptr;
+    static TH1D* h = nullptr;
+    static std::vector<TObject*> object_list;
+    static std::vector<std::string> path_list;
+    static std::vector<double> entry_list;
+    static TFile* f = nullptr;
+    static std::vector<TObject*> loaded_list;
+
+    auto delete_all = []()
+    {
+	delete c; c = nullptr;
+	delete g; g = nullptr;
+	delete g0; g0 = nullptr;
+	delete g1; g1 = nullptr;
+	delete h; h = nullptr;
+	for (auto* obj : loaded_list) delete obj;
+	loaded_list.clear();
+	if (f) f->Close();
+	delete f; f = nullptr;
+    };
+
+    return {
+	{
+	    "data_saver_write_canvas",
+	    [](const int size)
+	    {
+		c = rh::create_canvas("c_bench_write", "c_bench_write");
+		g = create_sine_graph(size);
+		g->Draw("AL");
+		rh::set_axes(g);
+	    },
+	    [output_directory](const int)
+	    {
+		rh::DataSaver data_saver(output_directory / "write_canvas", true);
+		data_saver.write_canvas(c);
+	    },
+	    delete_all
+	},
+	{
+	    "data_saver_save_object",
+	    [](const int size) { h = create_variable_bin_histo("h_bench_save", size, random); },
+	    [output_directory](const int)
+	    {
+		rh::DataSaver data_saver(output_directory / "save_object", true);
+		data_saver.save_object(h, "histo");
+	    },
+	    delete_all
+	},
+	{
+	    "object_list_load_data",
+	    [output_directory](const int size)
+	    {
+		std::filesystem::create_directories(output_directory);
+		const std::string file_name = (output_directory / "load_data.root").string();
+
+		path_list.clear();
+		TFile f_write(file_name.c_str(), "RECREATE");
+		for (int i = 0; i < size; ++i) {
+		    TH1D h_write(Form("h_%d", i), Form("h_%d", i), 100, 0, 1);
+		    h_write.Write();
+		    path_list.push_back(h_write.GetName());
+		}
+		f_write.Close();
+
+		// A fresh file for every repetition, so that no object is served from the in-memory list of a previous load.
+		f = TFile::Open(file_name.c_str());
+	    },
+	    [](const int)
+	    {
+		rh::ObjectList object_list("bench");
+		object_list.load_data<TH1D>(f, path_list);
+		loaded_list = object_list.get_object_list();
+	    },
+	    delete_all
+	},
+	{
+	    "multi_object_construct_draw",
+	    [](const int size)
+	    {
+		c = rh::create_canvas("c_bench_multi", "c_bench_multi");
+		object_list.clear();
+		for (int i = 0; i < size; ++i) object_list.push_back(create_sine_graph(100, 0.01 * i));
+	    },
+	    [](const int)
+	    {
+		rh::MultiObject multi_object(rh::MultiObjectType::Graph, "mg_bench", object_list);
+		multi_object.Draw();
+		c->Update();
+	    },
+	    delete_all
+	},
+	{
+	    "set_axes",
+	    [](const int size)
+	    {
+		c = rh::create_canvas("c_bench_axes", "c_bench_axes");
+		g = create_sine_graph(size);
+		g->Draw("AL");
+	    },
+	    [](const int) { rh::set_axes(g); },
+	    delete_all
+	},
+	{
+	    "get_max_label_width_ndc",
+	    [](const int)
+	    {
+		rh::clear_layout_cache();
+		c = rh::create_canvas("c_bench_label", "c_bench_label");
+		g = create_sine_graph(100);
+		g->Draw("AL");
+		c->Update();
+	    },
+	    [](const int size)
+	    {
+		for (int i = 0; i < size; ++i) {
+		    rh::get_max_label_width_ndc(g->GetYaxis(), -1. - i, 1. + i);
+		}
+	    },
+	    delete_all
+	},
+	{
+	    "find_x",
+	    [](const int size)
+	    {
+		g = new TGraph(size);
+		for (int i = 0; i < size; ++i) g->SetPoint(i, i, TMath::Sqrt(i));
+	    },
+	    [](const int size) { rh::find_x(g, TMath::Sqrt(size / 2.)); },
+	    delete_all
+	},
+	{
+	    "convert_to_density_histo",
+	    [](const int size) { h = create_variable_bin_histo("h_bench_density", size, random); },
+	    [](const int) { rh::convert_to_density_histo(h); },
+	    delete_all
+	},
+	{
+	    "get_graph_g0xa_plus_g1",
+	    [](const int size)
+	    {
+		g0 = create_graph_errors(size, random);
+		g1 = create_graph_errors(size, random);
+	    },
+	    [](const int) { delete rh::get_graph_g0xa_plus_g1(-1, g0, g1); },
+	    delete_all
+	},
+	{
+	    "bulk_fill_histo",
+	    [](const int size)
+	    {
+		h = new TH1D("h_bench_fill", "h_bench_fill", 1000, -5, 5);
+		entry_list.resize(size);
+		for (auto& x : entry_list) x = random.Gaus();
+	    },
+	    [](const int) { rh::bulk_fill_histo(h, entry_list); },
+	    delete_all
+	}
+    };
+}
+
+
+void write_json(const std::string& file_name, const std::vector<BenchResult>& result_list, const int n_repetition)
+{
+    std::ofstream ofs(file_name);
+
+    if (!ofs) {
+	fprintf(stderr, "%s could not be opened\n", file_name.c_str());
+	exit(1);
+    }
+
+    ofs << "{\n";
+    ofs << "  \"n_repetition\": " << n_repetition << ",\n";
+    ofs << "  \"result\": [\n";
+
+    for (size_t i = 0; i < result_list.size(); ++i) {
+	const BenchResult& result = result_list[i];
+	const auto& s = result.second_list;
+
+	double mean = 0;
+	for (const double t : s) mean += t;
+	mean /= s.size();
+
+	ofs << "    { \"name\": \"" << result.name << "\", \"size\": " << result.size
+	    << ", \"min_s\": " << *std::min_element(s.begin(), s.end())
+	    << ", \"mean_s\": " << mean
+	    << ", \"max_s\": " << *std::max_element(s.begin(), s.end()) << " }"
+	    << (i + 1 < result_list.size() ? "," : "") << "\n";
+    }
+
+    ofs << "  ]\n";
+    ofs << "}\n";
+}
@@ -0,0 +1,130 @@
+#include <ROOT_helper/ROOT_helper.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <TGraph.h>
+#include <TMath.h>
+#include <TRandom3.h>
+#include <TVirtualFFT.h>
+
+
+namespace rh = ROOT_helper;
+
+
+std::vector<TGraph*> create_waveforms(const int n_graph, const int n_point);
+
+
+/**
+ * Per-graph spectrum as written in ad-hoc macros: a new plan and window for every graph.
+ */
+TGraph* get_power_spectrum_naive(const TGraph* g);
+
+
+template<class FunctionType>
+double measure_seconds(FunctionType func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+
+int main(int argc, char** argv)
+{
+    const int n_graph = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int n_point = argc > 2 ? std::atoi(argv[2]) : 4096;
+
+    std::vector<TGraph*> graph_list = create_waveforms(n_graph, n_point);
+
+    std::vector<TGraph*> naive_list;
+    const double t_naive = measure_seconds([&]()
+    {
+	for (auto* g : graph_list) {
+	    naive_list.push_back(get_power_spectrum_naive(g));
+	}
+    });
+
+    std::vector<TGraph*> serial_list;
+    const double t_serial = measure_seconds([&]()
+    {
+	serial_list = rh::get_power_spectrum_graphs(graph_list, rh::WindowFunction::Hann, 1);
+    });
+
+    std::vector<TGraph*> parallel_list;
+    const double t_parallel = measure_seconds([&]()
+    {
+	parallel_list = rh::get_power_spectrum_graphs(graph_list, rh::WindowFunction::Hann);
+    });
+
+    std::cout << n_graph << " graphs x " << n_point << " points" << std::endl;
+    std::cout << "naive per-graph plan: " << t_naive << " s" << std::endl;
+    std::cout << "reused plan, 1 thread: " << t_serial << " s (x" << t_naive / t_serial << ")" << std::endl;
+    std::cout << "reused plan, " << rh::get_default_n_thread() << " threads: " << t_parallel << " s (x" << t_naive / t_parallel << ")" << std::endl;
+
+    for (auto* list : { &graph_list, &naive_list, &serial_list, &parallel_list }) {
+	for (auto* g : *list) delete g;
+    }
+
+    return 0;
+}
+
+
+std::vector<TGraph*> create_waveforms(const int n_graph, const int n_point)
+{
+    TRandom3 random(1);
+
+    std::vector<TGraph*> graph_list;
+
+    for (int i_graph = 0; i_graph < n_graph; ++i_graph) {
+	TGraph* g = new TGraph(n_point);
+	g->SetName(Form("g_wave_%d", i_graph));
+
+	const double frequency = random.Uniform(5, 50);
+	for (int i = 0; i < n_point; ++i) {
+	    const double t = i * 1e-3;
+	    g->SetPoint(i, t, TMath::Sin(TMath::TwoPi() * frequency * t) + random.Gaus(0, 0.1));
+	}
+
+	graph_list.push_back(g);
+    }
+
+    return graph_list;
+}
+
+
+TGraph* get_power_spectrum_naive(const TGraph* g)
+{
+    int n = g->GetN();
+
+    std::vector<double> window = rh::get_window_coefficients(rh::WindowFunction::Hann, n);
+    std::vector<double> buffer(n);
+    double window_square_sum = 0;
+    for (int i = 0; i < n; ++i) {
+	buffer[i] = g->GetY()[i] * window[i];
+	window_square_sum += window[i] * window[i];
+    }
+
+    TVirtualFFT* fft = TVirtualFFT::FFT(1, &n, "R2C M K");
+    fft->SetPoints(buffer.data());
+    fft->Transform();
+
+    const double frequency_step = (n - 1) / ((g->GetX()[n - 1] - g->GetX()[0]) * n);
+    const int n_frequency = n / 2 + 1;
+
+    TGraph* g_power = new TGraph(n_frequency);
+    for (int k = 0; k < n_frequency; ++k) {
+	double re, im;
+	fft->GetPointComplex(k, re, im);
+	const double factor = (k != 0 && !(n % 2 == 0 && k == n / 2)) ? 2 : 1;
+	g_power->SetPoint(k, k * frequency_step, factor * (re * re + im * im) / (frequency_step * n * window_square_sum));
+    }
+
+    delete fft;
+
+    return g_power;
+}
@@ -0,0 +1,106 @@
+#include "../ROOT_helper.h"
+
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+
+#include <TH1D.h>
+#include <TH2D.h>
+#include <TRandom3.h>
+
+
+namespace rh = ROOT_helper;
+
+
+/**
+ * Largest relative difference of contents, Sumw2, entries and statistics between two histograms.
+ */
+double get_max_difference(TH1* h0, TH1* h1);
+
+
+/**
+ * Compares bulk_fill_histo with Fill called entry by entry, including NaN, infinities and values far out of range.
+ */
+int test_bulk_fill()
+{
+    const int n = 1000000;
+
+    TRandom3 random(1);
+    std::vector<double> x(n), y(n), w(n);
+    for (int i = 0; i < n; ++i) {
+	x[i] = random.Gaus(0.5, 0.4);
+	y[i] = random.Gaus(0.5, 0.4);
+	w[i] = random.Uniform(0.5, 1.5);
+    }
+
+    x[0] = std::numeric_limits<double>::quiet_NaN();
+    x[1] = std::numeric_limits<double>::infinity();
+    x[2] = -std::numeric_limits<double>::infinity();
+    x[3] = 1e300;
+    x[4] = -1e300;
+    y[5] = std::numeric_limits<double>::quiet_NaN();
+    y[6] = 1e300;
+
+    std::vector<double> edge_list(38);
+    for (size_t i = 0; i < edge_list.size(); ++i) edge_list[i] = -0.2 + 1.5 * std::pow(i / 37., 2);
+
+    int n_failed = 0;
+    auto check = [&n_failed](const char* name, TH1* h_bulk, TH1* h_serial)
+    {
+	const double difference = get_max_difference(h_bulk, h_serial);
+	const bool is_ok = difference < 1e-9;
+	printf("%-24s max relative difference %g %s\n", name, difference, is_ok ? "OK" : "FAILED");
+	if (!is_ok) ++n_failed;
+    };
+
+    {
+	TH1D h_bulk("h_uniform_bulk", "", 37, -0.2, 1.3);
+	TH1D h_serial("h_uniform_serial", "", 37, -0.2, 1.3);
+	rh::bulk_fill_histo(&h_bulk, x);
+	for (int i = 0; i < n; ++i) h_serial.Fill(x[i]);
+	check("uniform", &h_bulk, &h_serial);
+    }
+
+    {
+	TH1D h_bulk("h_variable_bulk", "", 37, edge_list.data());
+	TH1D h_serial("h_variable_serial", "", 37, edge_list.data());
+	rh::bulk_fill_histo(&h_bulk, x, w);
+	for (int i = 0; i < n; ++i) h_serial.Fill(x[i], w[i]);
+	check("variable, weighted", &h_bulk, &h_serial);
+    }
+
+    {
+	TH2D h_bulk("h_2d_bulk", "", 13, 0, 1, 9, 0.1, 0.9);
+	TH2D h_serial("h_2d_serial", "", 13, 0, 1, 9, 0.1, 0.9);
+	rh::bulk_fill_histo(&h_bulk, x, y, w);
+	for (int i = 0; i < n; ++i) h_serial.Fill(x[i], y[i], w[i]);
+	check("2d, weighted", &h_bulk, &h_serial);
+    }
+
+    return n_failed;
+}
+
+
+double get_max_difference(TH1* h0, TH1* h1)
+{
+    auto relative_difference = [](const double v0, const double v1)
+    {
+	return std::abs(v0 - v1) / std::max(1., std::abs(v1));
+    };
+
+    double difference = relative_difference(h0->GetEntries(), h1->GetEntries());
+
+    for (int bin = 0; bin < h1->GetNcells(); ++bin) {
+	difference = std::max(difference, relative_difference(h0->GetBinContent(bin), h1->GetBinContent(bin)));
+	difference = std::max(difference, relative_difference(h0->GetBinError(bin), h1->GetBinError(bin)));
+    }
+
+    double stats0[7] = { 0, 0, 0, 0, 0, 0, 0 };
+    double stats1[7] = { 0, 0, 0, 0, 0, 0, 0 };
+    h0->GetStats(stats0);
+    h1->GetStats(stats1);
+    for (int i = 0; i < 7; ++i) difference = std::max(difference, relative_difference(stats0[i], stats1[i]));
+
+    return difference;
+}
@@ -0,0 +1,39 @@
+#include "../ROOT_helper.h"
+
+#include <TCanvas.h>
+#include <TGraph.h>
+#include <TMath.h>
+
+
+namespace rh = ROOT_helper;
+
+
+/**
+ * Touches the main helpers once; run through script/compare_startup_time.
+ */
+int test_startup_time()
+{
+    rh::prepare();
+
+    TCanvas* c = rh::create_canvas("c_startup", "c_startup", 2, 1);
+
+    TGraph* g = new TGraph(100);
+    for (int i = 0; i < 100; ++i) {
+	g->SetPoint(i, i, TMath::Sin(0.1 * i));
+    }
+
+    c->cd(1);
+    g->Draw("AL");
+    rh::set_axes(g);
+    rh::put_legend(rh::LegendPosition::Auto);
+
+    c->cd(2);
+    rh::draw_latex_ndc(0.2, 0.5, "startup");
+
+    c->Update();
+
+    delete c;
+    delete g;
+
+    return 0;
+}